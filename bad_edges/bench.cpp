@@ -0,0 +1,53 @@
+// Benchmark of the pairwise edge generation, one JSON document on stdout to diff between commits.
+// Usage: ./bench [maxSites]
+#include "voronoi.hpp"
+#include "benchmark.hpp"
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1200;
+const int HEIGHT = 800;
+const unsigned SEED = 12345;
+// Beyond this many pairs the edges no longer fit in memory (40 bytes each plus
+// two region pointers): the larger sizes are reported as skipped
+const size_t MAX_PAIRS = 5000000;
+const int SIZES[] = {10, 100, 1000, 10000, 100000};
+
+}
+
+int main(int argc, char const* argv[]) {
+    const int maxSites = (argc > 1) ? std::atoi(argv[1]) : 100000;
+
+    beginReport();
+    for (int sites : SIZES) {
+        if (sites > maxSites) {
+            break;
+        }
+        if (static_cast<size_t>(sites) * (sites - 1) / 2 > MAX_PAIRS) {
+            skip("generateEdges", sites);
+            continue;
+        }
+
+        // Same layout as Voronoi::addPoint, reserved so that the pointers stay valid
+        std::vector<VoronoiPoint> points;
+        std::vector<VoronoiRegion> regions;
+        std::vector<VoronoiEdge> edges;
+        points.reserve(sites);
+        regions.reserve(sites);
+        for (const auto& position : randomPoints(sites, SEED + sites, WIDTH, HEIGHT)) {
+            points.emplace_back(position.x, position.y);
+            regions.emplace_back(&points.back());
+            points.back().region = &regions.back();
+        }
+
+        measure("generateEdges", sites, 1, [&]() {
+            generateEdges(points, regions, edges);
+            sink = sink + edges.size();
+        });
+    }
+    endReport();
+
+    return EXIT_SUCCESS;
+}
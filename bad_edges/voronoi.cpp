@@ -15,6 +15,7 @@ Voronoi::Voronoi(int width, int height, int initialPoints)
       window(sf::VideoMode(width, height), "Voronoi Diagram", sf::Style::Close | sf::Style::Titlebar, sf::ContextSettings(0, 0, 8)),
       gen(dev()), wRand(30.0, width - 30.0), hRand(30.0, height - 30.0) {
 
+    window.setFramerateLimit(60);
     window.setPosition(sf::Vector2i(0, 0));
     coordinates.resize(pointsNumber);
     std::generate(coordinates.begin(), coordinates.end(), [&]() { return sf::Vector2f(wRand(gen), hRand(gen)); });
@@ -65,6 +66,11 @@ bool Voronoi::initialize() {
         return false;
     }
 
+    if (!diagram.create(WIDTH, HEIGHT)) {
+        std::cerr << "Failed to create the diagram texture!" << std::endl;
+        return false;
+    }
+
     return true;
 }
 
@@ -97,6 +103,7 @@ void Voronoi::addPoint(sf::Vector2f position) {
 #endif
 
     pointsNumber++;
+    diagramDirty = true;
 }
 
 void Voronoi::generateGraph(Graph& graph) {
@@ -111,6 +118,31 @@ VoronoiEdge::VoronoiEdge(VoronoiPoint* s, VoronoiPoint* e, const sf::Vector2f& s
 
 VoronoiRegion::VoronoiRegion(VoronoiPoint* p) : point(p) {}
 
+void generateEdges(std::vector<VoronoiPoint>& points, std::vector<VoronoiRegion>& regions, std::vector<VoronoiEdge>& edges) {
+    edges.clear();
+    // The regions keep pointers into `edges`, which must not move while it fills
+    edges.reserve(points.empty() ? 0 : points.size() * (points.size() - 1) / 2);
+    for (auto& region : regions) {
+        region.edges.clear();
+    }
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        for (size_t j = i + 1; j < points.size(); ++j) {
+            float distance = std::hypot(points[i].location.x - points[j].location.x, points[i].location.y - points[j].location.y);
+
+            sf::Vector2f midPoint = (points[i].location + points[j].location) / 2.f;
+            sf::Vector2f direction = points[j].location - points[i].location;
+            sf::Vector2f perpendicular = sf::Vector2f(-direction.y, direction.x);
+            sf::Vector2f start = midPoint + perpendicular;
+            sf::Vector2f end = midPoint - perpendicular;
+            edges.emplace_back(&points[i], &points[j], start, end, distance);
+
+            regions[i].edges.push_back(&edges.back());
+            regions[j].edges.push_back(&edges.back());
+        }
+    }
+}
+
 void addEdge(Graph& graph, const sf::Vector2f& start, const sf::Vector2f& end) {
     auto& startVertex = graph.vertices[start];
     auto& endVertex = graph.vertices[end];
@@ -424,9 +456,10 @@ void Voronoi::update() {
         circles[i].first.setRadius(radius);
         circles[i].first.setOrigin(radius, radius);
 
-        if (circles[i].second) {
-            coordinates[i] = sf::Vector2f(sf::Mouse::getPosition(window));
+        if (circles[i].second && coordinates[i] != sf::Vector2f(mousePos)) {
+            coordinates[i] = sf::Vector2f(mousePos);
             circles[i].first.setPosition(coordinates[i]);
+            diagramDirty = true;
         }
     }
 }
@@ -488,11 +521,29 @@ void Voronoi::update() {
 
 
 void Voronoi::render() {
+    if (diagramDirty) {
+        renderDiagram();
+    }
+
     window.clear(sf::Color::White);
+    window.draw(sf::Sprite(diagram.getTexture()));
+    
+    // Draw the circles (Voronoi points)
+    for (auto& c : circles) {
+        window.draw(c.first);
+    }
+    
+    window.draw(edgeLines);
+
+    window.display();
+}
+
+void Voronoi::renderDiagram() {
+    diagram.clear(sf::Color::White);
 
     std::vector<sf::Vector2f> copy(coordinates.size());
     std::transform(coordinates.begin(), coordinates.end(), copy.begin(), [&](sf::Vector2f vec) {
-        return sf::Vector2f(vec.x, window.getSize().y - vec.y);
+        return sf::Vector2f(vec.x, diagram.getSize().y - vec.y);
     });
 
     shader.setUniform("size", pointsNumber);
@@ -502,29 +553,18 @@ void Voronoi::render() {
     shader.setUniformArray("colors", colors.data(), MAX_POINTS_NUMBER);
 #endif
 
-    window.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
-    
-    // Draw the circles (Voronoi points)
-    for (auto& c : circles) {
-        window.draw(c.first);
-    }
-    
-    const float RED_THRESHOLD = 10.0;     // Red color for edges within 50 units of a guard tower
-    const float ORANGE_THRESHOLD = 500.0; // Orange color for edges within 100 units of a guard tower
-    const float YELLOW_THRESHOLD = 100.0;
-    // if (voronoiEdges.empty()){
-    //     std::cout << "kikou" << std::endl;
-    // }
-    // Draw the edges with color coding based on their distances to the guard towers
+    diagram.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
+    diagram.display();
+
+    // One draw call for all the edges instead of one per edge
+    edgeLines.setPrimitiveType(sf::Lines);
+    edgeLines.clear();
     for (const VoronoiEdge& edge : edges) {
-        sf::Vertex line[] = {
-            sf::Vertex(edge.startPoint, sf::Color::Black),
-            sf::Vertex(edge.endPoint, sf::Color::Black)
-        };
-        window.draw(line, 2, sf::Lines);
+        edgeLines.append(sf::Vertex(edge.startPoint, sf::Color::Black));
+        edgeLines.append(sf::Vertex(edge.endPoint, sf::Color::Black));
     }
 
-    window.display();
+    diagramDirty = false;
 }
 
 
@@ -597,6 +637,7 @@ void Voronoi::render() {
 
 void Voronoi::displayPath(const std::vector<VoronoiEdge*>& path) {
     sf::RenderWindow pathWindow(sf::VideoMode(WIDTH, HEIGHT), "Shortest Path", sf::Style::Close | sf::Style::Titlebar, sf::ContextSettings(0, 0, 8));
+    pathWindow.setFramerateLimit(60);
 
     while (pathWindow.isOpen()) {
         sf::Event pathEvent;
@@ -609,14 +650,10 @@ void Voronoi::displayPath(const std::vector<VoronoiEdge*>& path) {
         pathWindow.clear(sf::Color::White);
         
         // Draw the original Voronoi diagram
-        shader.setUniform("size", pointsNumber);
-        shader.setUniformArray("seeds", coordinates.data(), MAX_POINTS_NUMBER);
-
-#ifdef COLORS
-        shader.setUniformArray("colors", colors.data(), MAX_POINTS_NUMBER);
-#endif
-
-        pathWindow.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
+        if (diagramDirty) {
+            renderDiagram();
+        }
+        pathWindow.draw(sf::Sprite(diagram.getTexture()));
 
         // Draw the circles (Voronoi points)
         for (const auto& point : voronoiPoints) {
@@ -61,6 +61,9 @@ public:
     VoronoiRegion(VoronoiPoint* p);
 };
 
+// Bisector segment of every pair of points, O(n^2), and the edges of every region
+void generateEdges(std::vector<VoronoiPoint>& points, std::vector<VoronoiRegion>& regions, std::vector<VoronoiEdge>& edges);
+
 class Voronoi {
 public:
     Voronoi(int width, int height, int initialPoints);
@@ -78,32 +81,8 @@ public:
     }
 
     void generateEdges() {
-        
-        edges.clear();
-        for (size_t i = 0; i < points.size(); ++i) {
-            
-            for (size_t j = i + 1; j < points.size(); ++j) {
-                float distance = std::hypot(points[i].location.x - points[j].location.x, points[i].location.y - points[j].location.y);
-
-                sf::Vector2f midPoint = (points[i].location + points[j].location) / 2.f;
-                sf::Vector2f direction = points[j].location - points[i].location;
-                sf::Vector2f perpendicular = sf::Vector2f(-direction.y, direction.x);
-                sf::Vector2f start = midPoint + perpendicular;
-                sf::Vector2f end = midPoint - perpendicular;
-                edges.emplace_back(&points[i], &points[j], start, end, distance);
-
-                
-                regions[i].edges.push_back(&edges.back());
-                regions[j].edges.push_back(&edges.back());
-                
-            }
-        }
-        if(edges.empty()){
-            std::cout<<"adios"<<std::endl;
-        }
+        ::generateEdges(points, regions, edges);
     }
-    
-
 
     void generateGraph(Graph& graph);
 
@@ -111,6 +90,7 @@ private:
     void handleEvents();
     void update();
     void render();
+    void renderDiagram();
     void addPoint(sf::Vector2f position);
 
     void generateGraph();
@@ -124,6 +104,11 @@ private:
 
     sf::RenderWindow window;
     sf::Shader shader;
+    // Shader output and edge lines, only rebuilt when the sites change; the
+    // sites are drawn on top of them every frame
+    sf::RenderTexture diagram;
+    sf::VertexArray edgeLines;
+    bool diagramDirty = true;
     std::vector<sf::Vector2f> coordinates;
     std::vector<std::pair<sf::CircleShape, bool>> circles;
 
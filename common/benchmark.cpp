@@ -0,0 +1,65 @@
+#include "benchmark.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+
+std::atomic<long> allocations(0);
+volatile double sink = 0.0;
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+bool first = true;
+
+void separate() {
+    std::cout << (first ? "" : ",\n");
+    first = false;
+}
+
+}
+
+void beginReport() {
+    std::cout << "{\"benchmarks\": [\n";
+}
+
+void endReport() {
+    std::cout << "\n]}" << std::endl;
+}
+
+void report(const char* name, int sites, double ops, double seconds, long allocated) {
+    separate();
+    std::cout << "  {\"name\": \"" << name << "\", \"sites\": " << sites << ", \"ns_per_op\": " << seconds * 1e9 / ops
+              << ", \"allocs_per_op\": " << allocated / ops << ", \"ops\": " << static_cast<long>(ops) << "}";
+}
+
+void skip(const char* name, int sites) {
+    separate();
+    std::cout << "  {\"name\": \"" << name << "\", \"sites\": " << sites << ", \"skipped\": true}";
+}
+
+std::vector<sf::Vector2f> randomPoints(int count, unsigned seed, int width, int height) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> x(0.0f, width);
+    std::uniform_real_distribution<float> y(0.0f, height);
+    std::vector<sf::Vector2f> points(count);
+    for (auto& point : points) {
+        point = sf::Vector2f(x(gen), y(gen));
+    }
+    return points;
+}
@@ -0,0 +1,50 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <SFML/System.hpp>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Shared by the ./bench of every app: one JSON document on stdout, to diff
+// between commits. benchmark.cpp replaces the global operator new, so link
+// it into the benchmarks only.
+
+// Every allocation of the process so far, pool threads included
+extern std::atomic<long> allocations;
+// Keeps the optimizer from dropping the results
+extern volatile double sink;
+
+const double MIN_SECONDS = 0.2;
+
+// Opens and closes the list of results
+void beginReport();
+void endReport();
+// One result: `ops` operations took `seconds` and `allocated` allocations
+void report(const char* name, int sites, double ops, double seconds, long allocated);
+// A case too large to run at this size
+void skip(const char* name, int sites);
+
+// `count` points uniformly spread over a width x height board
+std::vector<sf::Vector2f> randomPoints(int count, unsigned seed, int width, int height);
+
+// Repeats `run` for at least MIN_SECONDS, each run doing `ops` operations
+template <typename Run>
+void measure(const char* name, int sites, int ops, Run run) {
+    run(); // warm up
+
+    long runs = 0;
+    long allocated = 0;
+    double seconds = 0.0;
+    while (seconds < MIN_SECONDS) {
+        long before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        run();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        allocated += allocations - before;
+        runs++;
+    }
+    report(name, sites, static_cast<double>(runs) * ops, seconds, allocated);
+}
+
+#endif // BENCHMARK_HPP
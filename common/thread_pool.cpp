@@ -0,0 +1,71 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(unsigned threads)
+    : task(nullptr), count(0), next(0), busy(0), generation(0), stopping(false) {
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::drain() {
+    for (size_t i = next++; i < count; i = next++) {
+        (*task)(i);
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)>& f) {
+    if (workers.empty() || n <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &f;
+        count = n;
+        next = 0;
+        busy = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busy == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::work() {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers running one parallelFor at a time; the caller helps.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls task(i) for every i in [0, count), returns once all calls are done
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+private:
+    void work();
+    void drain();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(size_t)>* task;
+    size_t count;
+    std::atomic<size_t> next;
+    unsigned busy;
+    unsigned long generation;
+    bool stopping;
+};
+
+#endif // THREAD_POOL_HPP
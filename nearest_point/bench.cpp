@@ -0,0 +1,406 @@
+// Benchmarks of the quadtree, one JSON document on stdout to diff between commits.
+// Usage: ./bench [maxSites]
+#include "quadtree.hpp"
+#include "delaunay.hpp"
+#include "spatial_grid.hpp"
+#include "nearest_batch.hpp"
+#include "nearest_raster.hpp"
+#include "pack_finder.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include "world.hpp"
+#include "benchmark.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1920;
+const int HEIGHT = 1080;
+const unsigned SEED = 12345;
+const int QUERIES = 1000;
+const int BATCH = 1000000; // units queried per tick
+const size_t K = 8;
+const float RADIUS = 50.0f;
+const float SPEED = 2.0f; // pixels per tick of the moving units
+const int CLUSTERS = 16;
+const float CLUSTER_SPREAD = 30.0f;
+const int SIZES[] = {10, 100, 1000, 10000, 100000};
+const int SITES_PER_SCREEN = 100; // density of the World case, whatever its size
+
+// Packs gathered in CLUSTERS gaussian clusters, the case the quadtree is for
+std::vector<sf::Vector2f> clusteredPoints(int count, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> x(0.0f, WIDTH);
+    std::uniform_real_distribution<float> y(0.0f, HEIGHT);
+    std::vector<sf::Vector2f> centers(CLUSTERS);
+    for (auto& center : centers) {
+        center = sf::Vector2f(x(gen), y(gen));
+    }
+    std::normal_distribution<float> spread(0.0f, CLUSTER_SPREAD);
+    std::vector<sf::Vector2f> points(count);
+    for (size_t i = 0; i < points.size(); ++i) {
+        const sf::Vector2f& center = centers[i % CLUSTERS];
+        points[i] = sf::Vector2f(std::min(std::max(center.x + spread(gen), 0.0f), static_cast<float>(WIDTH)),
+                                 std::min(std::max(center.y + spread(gen), 0.0f), static_cast<float>(HEIGHT)));
+    }
+    return points;
+}
+
+std::vector<Point> packs(const std::vector<sf::Vector2f>& positions) {
+    std::vector<Point> result;
+    for (const auto& position : positions) {
+        result.push_back({position, true});
+    }
+    return result;
+}
+
+// One tick of units moving in straight lines, bouncing on the borders
+void moveUnits(std::vector<sf::Vector2f>& positions, std::vector<sf::Vector2f>& velocities) {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i] += velocities[i];
+        if (positions[i].x < 0 || positions[i].x > WIDTH) {
+            velocities[i].x = -velocities[i].x;
+        }
+        if (positions[i].y < 0 || positions[i].y > HEIGHT) {
+            velocities[i].y = -velocities[i].y;
+        }
+    }
+}
+
+}
+
+int main(int argc, char const* argv[]) {
+    const int maxSites = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    const std::vector<sf::Vector2f> queries = randomPoints(QUERIES, SEED - 1, WIDTH, HEIGHT);
+    const sf::FloatRect bounds(0, 0, WIDTH, HEIGHT);
+    const std::vector<sf::Vector2f> units = randomPoints(BATCH, SEED - 2, WIDTH, HEIGHT);
+    std::vector<Point> results(BATCH);
+    ThreadPool pool;
+    NearestBatch batch(pool);
+
+    std::vector<sf::Vector2f> velocities(QUERIES);
+    std::mt19937 gen(SEED - 3);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    for (auto& velocity : velocities) {
+        const float a = angle(gen);
+        velocity = sf::Vector2f(SPEED * std::cos(a), SPEED * std::sin(a));
+    }
+
+    beginReport();
+    for (int sites : SIZES) {
+        if (sites > maxSites) {
+            break;
+        }
+        const std::vector<sf::Vector2f> points = randomPoints(sites, SEED + sites, WIDTH, HEIGHT);
+
+        Quadtree built(bounds);
+        measure("Quadtree::insert", sites, sites, [&]() {
+            built.clear();
+            for (const auto& point : points) {
+                built.insert({point, true});
+            }
+        });
+
+        // Removes then reinserts every point: the tree merges and splits back
+        measure("Quadtree::remove+insert", sites, sites, [&]() {
+            for (const auto& point : points) {
+                built.remove(point);
+                built.insert({point, true});
+            }
+        });
+
+        // Every site drifting a little each frame, as when dragged or animated
+        std::vector<sf::Vector2f> drifting = points;
+        std::vector<sf::Vector2f> drifts(sites);
+        std::uniform_real_distribution<float> drift(-SPEED, SPEED);
+        for (auto& velocity : drifts) {
+            velocity = sf::Vector2f(drift(gen), drift(gen));
+        }
+        Quadtree moving(bounds);
+        std::vector<int> ids;
+        for (const auto& position : drifting) {
+            ids.push_back(moving.insert({position, true}));
+        }
+        measure("Quadtree::move", sites, sites, [&]() {
+            moveUnits(drifting, drifts);
+            for (int i = 0; i < sites; ++i) {
+                moving.move(ids[i], drifting[i]);
+            }
+        });
+
+        // Packs picked up then respawned in place, the structure never changes
+        measure("Quadtree::setAvailable", sites, sites, [&]() {
+            for (const auto& point : points) {
+                built.setAvailable(point, false);
+                built.setAvailable(point, true);
+            }
+        });
+
+        Point point;
+        measure("Quadtree::nearest", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                built.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        std::vector<Point> found;
+        measure("Quadtree::kNearest", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                built.kNearest(query, K, found);
+                sink = sink + found.size();
+            }
+        });
+
+        measure("Quadtree::withinRadius", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                found.clear();
+                built.withinRadius(query, RADIUS, found);
+                sink = sink + found.size();
+            }
+        });
+
+        measure("nearestHealthPack", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                sink = sink + nearestHealthPack(built, query).position.x;
+            }
+        });
+
+        // Nine packs out of ten picked up: the empty subtrees are skipped
+        for (size_t i = 0; i < points.size(); ++i) {
+            built.setAvailable(points[i], i % 10 == 0);
+        }
+        measure("Quadtree::nearest (90% picked up)", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                built.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+        for (const auto& position : points) {
+            built.setAvailable(position, true);
+        }
+
+        // The same units moving a little every tick, as in a game
+        std::vector<sf::Vector2f> walkers = queries;
+        std::vector<sf::Vector2f> walkerVelocities = velocities;
+        measure("Quadtree::nearest (moving)", sites, QUERIES, [&]() {
+            moveUnits(walkers, walkerVelocities);
+            for (const auto& walker : walkers) {
+                built.nearest(walker, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        // Same packs in the uniform grid, with and without the AVX2 kernel
+        const std::vector<Point> uniform = packs(points);
+        SpatialGrid grid;
+        measure("SpatialGrid::build", sites, sites, [&]() { grid.build(uniform); });
+
+        measure("SpatialGrid::nearest", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                grid.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        SpatialGrid scalar(false);
+        scalar.build(uniform);
+        measure("SpatialGrid::nearest (scalar)", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                scalar.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        measure("SpatialGrid::kNearest", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                grid.kNearest(query, K, found);
+                sink = sink + found.size();
+            }
+        });
+
+        measure("SpatialGrid::withinRadius", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                found.clear();
+                grid.withinRadius(query, RADIUS, found);
+                sink = sink + found.size();
+            }
+        });
+
+        // Clustered packs: makeSpatialIndex should pick the faster of the two
+        const std::vector<Point> clustered = packs(clusteredPoints(sites, SEED + sites));
+        Quadtree clusteredTree(bounds);
+        for (const auto& pack : clustered) {
+            clusteredTree.insert(pack);
+        }
+        measure("Quadtree::nearest (clustered)", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                clusteredTree.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        grid.build(clustered);
+        measure("SpatialGrid::nearest (clustered)", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                grid.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        measure("makeSpatialIndex", sites, sites, [&]() { sink = sink + makeSpatialIndex(uniform, bounds)->available(); });
+
+        NearestRaster raster(bounds, 8.0f);
+        measure("NearestRaster::build", sites, sites, [&]() {
+            raster.build(uniform);
+            raster.refresh();
+        });
+
+        measure("NearestRaster::nearest", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                raster.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        // A pack appearing then vanishing at each query: only the tiles it
+        // touches are rebuilt, by the query that follows
+        measure("NearestRaster::insert+remove", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                const int id = raster.insert({query, true});
+                raster.nearest(query, point);
+                raster.remove(id);
+                raster.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+
+        // One screen of a world holding all the sites at a fixed density:
+        // the sites sent to the shaders for its tiles, which should not
+        // depend on the size of the world
+        const float scale = std::max(1.0f, std::sqrt(static_cast<float>(sites) / SITES_PER_SCREEN));
+        std::vector<sf::Vector2f> spread = points;
+        for (auto& position : spread) {
+            position *= scale;
+        }
+        World world(sf::FloatRect(0, 0, WIDTH * scale, HEIGHT * scale), World::TILE_PIXELS);
+        std::vector<int> affecting;
+        measure("World::affecting (one screen)", sites, 1, [&]() {
+            const float x0 = std::floor(WIDTH * (scale - 1) / 2 / World::TILE_PIXELS) * World::TILE_PIXELS;
+            const float y0 = std::floor(HEIGHT * (scale - 1) / 2 / World::TILE_PIXELS) * World::TILE_PIXELS;
+            for (float y = y0; y < y0 + HEIGHT; y += World::TILE_PIXELS) {
+                for (float x = x0; x < x0 + WIDTH; x += World::TILE_PIXELS) {
+                    world.affecting(spread.data(), spread.size(), sf::FloatRect(x, y, World::TILE_PIXELS, World::TILE_PIXELS), affecting);
+                    sink = sink + affecting.size();
+                }
+            }
+        });
+
+        DelaunayLocator locator;
+        measure("DelaunayLocator::build", sites, sites, [&]() { locator.build(points); });
+
+        measure("DelaunayLocator::nearest (cold)", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                sink = sink + locator.nearest(query);
+            }
+        });
+
+        // Built indices saved then mapped back, instead of rebuilt
+        const char* path = "bench.snap";
+        measure("Snapshot::write", sites, sites, [&]() {
+            SnapshotWriter writer;
+            writer.add(Snapshot::SITES, points.data(), points.size());
+            built.save(writer);
+            locator.save(writer);
+            writer.write(path);
+        });
+
+        // Sections read in place: QUICK checks sizes only, FULL adds the
+        // checksums and the consistency walks
+        Quadtree loadedTree(bounds);
+        DelaunayLocator loadedLocator;
+        measure("Snapshot::open+load", sites, sites, [&]() {
+            std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+            snapshot->open(path);
+            sink = sink + loadedTree.load(snapshot) + loadedLocator.load(snapshot);
+        });
+        measure("Snapshot::open+load (full check)", sites, sites, [&]() {
+            std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+            snapshot->open(path, Snapshot::FULL);
+            sink = sink + loadedTree.load(snapshot) + loadedLocator.load(snapshot);
+        });
+        measure("Quadtree::nearest (mapped)", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                loadedTree.nearest(query, point);
+                sink = sink + point.position.x;
+            }
+        });
+        std::remove(path);
+
+        walkers = queries;
+        walkerVelocities = velocities;
+        std::vector<int> hints(QUERIES, DelaunayLocator::NONE);
+        measure("DelaunayLocator::nearest (moving)", sites, QUERIES, [&]() {
+            moveUnits(walkers, walkerVelocities);
+            for (size_t i = 0; i < walkers.size(); ++i) {
+                hints[i] = locator.nearest(walkers[i], hints[i]);
+                sink = sink + hints[i];
+            }
+        });
+
+        // The app's query, PackFinder, for units moving over packs that do
+        // not change: the triangulation is built after one query per pack,
+        // then walked
+        PackFinder finder(built);
+        walkers = queries;
+        walkerVelocities = velocities;
+        std::fill(hints.begin(), hints.end(), DelaunayLocator::NONE);
+        for (int i = 0; i < sites; ++i) {
+            sink = sink + finder.nearest(queries[i % QUERIES], hints[i % QUERIES]).position.x;
+        }
+        measure("findNearestHealthPack (moving)", sites, QUERIES, [&]() {
+            moveUnits(walkers, walkerVelocities);
+            for (size_t i = 0; i < walkers.size(); ++i) {
+                sink = sink + finder.nearest(walkers[i], hints[i]).position.x;
+            }
+        });
+
+        // A site with a pack dragged under the cursor, one query per frame:
+        // each move only marks the triangulation stale, the quadtree answers
+        Quadtree dragTree(bounds);
+        std::vector<int> dragIds;
+        for (const auto& position : points) {
+            dragIds.push_back(dragTree.insert({position, true}));
+        }
+        PackFinder dragFinder(dragTree);
+        sf::Vector2f cursor = queries[0], cursorVelocity = velocities[0];
+        int cursorHint = DelaunayLocator::NONE;
+        measure("findNearestHealthPack (dragging)", sites, 1, [&]() {
+            cursor += cursorVelocity;
+            if (cursor.x < 0 || cursor.x > WIDTH || cursor.y < 0 || cursor.y > HEIGHT) {
+                cursorVelocity = -cursorVelocity;
+            }
+            dragTree.move(dragIds[0], cursor);
+            dragFinder.changed();
+            sink = sink + dragFinder.nearest(cursor, cursorHint).position.x;
+        });
+
+        measure("NearestBatch::run", sites, BATCH, [&]() {
+            batch.run(built, units.data(), units.size(), results.data());
+            sink = sink + results[0].position.x;
+        });
+
+        measure("NearestBatch::run (raster)", sites, BATCH, [&]() {
+            batch.run(raster, units.data(), units.size(), results.data());
+            sink = sink + results[0].position.x;
+        });
+    }
+    endReport();
+
+    return EXIT_SUCCESS;
+}
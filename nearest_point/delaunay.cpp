@@ -0,0 +1,397 @@
+#include "delaunay.hpp"
+#include "snapshot.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// En double : des sites à un millième de pixel l'un de l'autre auraient la
+// même distance en float, et la marche s'arrêterait avant le plus proche
+double squaredDistance(const sf::Vector2f& a, const sf::Vector2f& b) {
+    double dx = static_cast<double>(a.x) - b.x;
+    double dy = static_cast<double>(a.y) - b.y;
+    return dx * dx + dy * dy;
+}
+
+// Intercale les 16 bits bas de v avec des zéros
+uint32_t spread(uint32_t v) {
+    v &= 0xffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+}
+
+const int DelaunayLocator::NONE;
+
+DelaunayLocator::DelaunayLocator() : side(0), stamp(0) {}
+
+void DelaunayLocator::build(const std::vector<sf::Vector2f>& positions) {
+    sites.clear();
+    offsets.assign(1, 0);
+    neighbours.clear();
+    grid.clear();
+    side = 0;
+    if (positions.empty()) {
+        return;
+    }
+
+    float left = positions[0].x, right = left, top = positions[0].y, bottom = top;
+    for (const auto& position : positions) {
+        left = std::min(left, position.x);
+        right = std::max(right, position.x);
+        top = std::min(top, position.y);
+        bottom = std::max(bottom, position.y);
+    }
+    box = sf::FloatRect(left, top, right - left, bottom - top);
+
+    // Ordre de Morton, doublons retirés : chaque insertion part du triangle de
+    // la précédente, tout proche
+    const float scaleX = 65535.f / std::max(box.width, 1e-6f);
+    const float scaleY = 65535.f / std::max(box.height, 1e-6f);
+    order.clear();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        uint32_t x = static_cast<uint32_t>((positions[i].x - left) * scaleX);
+        uint32_t y = static_cast<uint32_t>((positions[i].y - top) * scaleY);
+        order.push_back({spread(x) | (spread(y) << 1), static_cast<int>(i)});
+    }
+    std::sort(order.begin(), order.end(), [&](const std::pair<uint32_t, int>& a, const std::pair<uint32_t, int>& b) {
+        const sf::Vector2f& p = positions[a.second];
+        const sf::Vector2f& q = positions[b.second];
+        return a.first != b.first ? a.first < b.first : (p.x != q.x ? p.x < q.x : p.y < q.y);
+    });
+    for (const auto& entry : order) {
+        const sf::Vector2f& position = positions[entry.second];
+        if (sites.empty() || sites.back() != position) {
+            sites.push_back(position);
+        }
+    }
+
+    const int n = static_cast<int>(sites.size());
+    if (!triangulate()) {
+        // Sites tous alignés : le graphe de Delaunay est le chemin qui les
+        // relie dans l'ordre le long de la droite
+        std::sort(sites.begin(), sites.end(), [](const sf::Vector2f& p, const sf::Vector2f& q) {
+            return p.x != q.x ? p.x < q.x : p.y < q.y;
+        });
+        triangles.clear();
+    }
+
+    // Graphe de Delaunay en CSR, sans les arêtes vers l'infini. Chaque arête
+    // est vue par ses deux triangles, prise une fois
+    offsets.assign(n + 1, 0);
+    if (triangles.empty()) {
+        for (int i = 1; i < n; ++i) {
+            offsets[i]++;
+            offsets[i + 1]++;
+        }
+    }
+    for (int t = 0; t < static_cast<int>(triangles.size()); ++t) {
+        const Triangle& triangle = triangles[t];
+        for (int i = 0; i < 3; ++i) {
+            const int a = triangle.v[(i + 1) % 3];
+            const int b = triangle.v[(i + 2) % 3];
+            if (a < n && b < n && triangle.adj[i] > t) {
+                offsets[a + 1]++;
+                offsets[b + 1]++;
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    neighbours.resize(offsets[n]);
+    std::vector<int>& next = byFirst; // têtes d'écriture, le tampon ne sert plus
+    next.resize(n + 1);
+    std::copy(offsets.begin(), offsets.end() - 1, next.begin());
+    if (triangles.empty()) {
+        for (int i = 1; i < n; ++i) {
+            neighbours[next[i - 1]++] = i;
+            neighbours[next[i]++] = i - 1;
+        }
+    }
+    for (int t = 0; t < static_cast<int>(triangles.size()); ++t) {
+        const Triangle& triangle = triangles[t];
+        for (int i = 0; i < 3; ++i) {
+            const int a = triangle.v[(i + 1) % 3];
+            const int b = triangle.v[(i + 2) % 3];
+            if (a < n && b < n && triangle.adj[i] > t) {
+                neighbours[next[a]++] = b;
+                neighbours[next[b]++] = a;
+            }
+        }
+    }
+
+    // Environ deux sites par case ; chaque case part de la précédente en
+    // serpentin, la grille coûte O(n)
+    side = std::max(1, static_cast<int>(std::sqrt(n / 2.0)));
+    grid.resize(side * side);
+    int previous = 0;
+    for (int y = 0; y < side; ++y) {
+        for (int k = 0; k < side; ++k) {
+            const int x = (y % 2 == 0) ? k : side - 1 - k;
+            const sf::Vector2f centre(left + (x + 0.5f) * box.width / side, top + (y + 0.5f) * box.height / side);
+            previous = walk(centre, previous);
+            grid[y * side + x] = previous;
+        }
+    }
+}
+
+bool DelaunayLocator::triangulate() {
+    const int n = static_cast<int>(sites.size());
+    const int infinite = n;
+    points.resize(n + 1);
+    for (int i = 0; i < n; ++i) {
+        points[i] = sf::Vector2<double>(sites[i].x, sites[i].y);
+    }
+
+    // Premier triangle : les deux premiers sites et le premier qui n'est pas
+    // aligné avec eux
+    int third = 2;
+    while (third < n && orientation(0, 1, third) == 0) {
+        third++;
+    }
+    if (third >= n) {
+        return false;
+    }
+    int a = 0, b = 1, c = third;
+    if (orientation(a, b, c) < 0) {
+        std::swap(a, b);
+    }
+
+    // Le triangle (a, b, c) et les trois fantômes collés à ses arêtes, dans
+    // l'ordre des sommets opposés
+    triangles.assign(4, Triangle());
+    triangles[0] = Triangle{{a, b, c}, {1, 2, 3}};
+    triangles[1] = Triangle{{c, b, infinite}, {3, 2, 0}};
+    triangles[2] = Triangle{{a, c, infinite}, {1, 3, 0}};
+    triangles[3] = Triangle{{b, a, infinite}, {2, 1, 0}};
+    marks.assign(4, stamp);
+    byFirst.resize(n + 1);
+
+    int last = 0;
+    for (int i = 2; i < n; ++i) {
+        if (i != third) {
+            insert(i, last);
+        }
+    }
+    return true;
+}
+
+double DelaunayLocator::orientation(int a, int b, int c) const {
+    const sf::Vector2<double>& pa = points[a];
+    const sf::Vector2<double>& pb = points[b];
+    const sf::Vector2<double>& pc = points[c];
+    return (pb.x - pa.x) * (pc.y - pa.y) - (pb.y - pa.y) * (pc.x - pa.x);
+}
+
+void DelaunayLocator::ghostEdge(const Triangle& triangle, int& a, int& b) const {
+    const int infinite = static_cast<int>(sites.size());
+    const int i = (triangle.v[0] == infinite) ? 0 : (triangle.v[1] == infinite ? 1 : 2);
+    a = triangle.v[(i + 1) % 3];
+    b = triangle.v[(i + 2) % 3];
+}
+
+bool DelaunayLocator::inCircumcircle(const Triangle& triangle, int vertex) const {
+    const int infinite = static_cast<int>(sites.size());
+    if (triangle.v[0] == infinite || triangle.v[1] == infinite || triangle.v[2] == infinite) {
+        // Le « cercle » d'un fantôme est le demi-plan au-delà de son arête,
+        // plus l'intérieur de l'arête elle-même
+        int a, b;
+        ghostEdge(triangle, a, b);
+        const double side = orientation(a, b, vertex);
+        if (side != 0) {
+            return side > 0;
+        }
+        const sf::Vector2<double>& p = points[vertex];
+        const double along = (p.x - points[a].x) * (points[b].x - points[a].x) + (p.y - points[a].y) * (points[b].y - points[a].y);
+        const double length = (points[b].x - points[a].x) * (points[b].x - points[a].x) +
+                              (points[b].y - points[a].y) * (points[b].y - points[a].y);
+        return along > 0 && along < length;
+    }
+
+    const sf::Vector2<double>& d = points[vertex];
+    const double adx = points[triangle.v[0]].x - d.x, ady = points[triangle.v[0]].y - d.y;
+    const double bdx = points[triangle.v[1]].x - d.x, bdy = points[triangle.v[1]].y - d.y;
+    const double cdx = points[triangle.v[2]].x - d.x, cdy = points[triangle.v[2]].y - d.y;
+    const double det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) +
+                       (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+                       (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+    return det > 0;
+}
+
+void DelaunayLocator::insert(int vertex, int& last) {
+    // Marche de visibilité jusqu'au triangle qui contient le point, ou au
+    // fantôme dont l'arête le voit s'il est hors de l'enveloppe. Elle termine
+    // toujours sur une triangulation de Delaunay
+    const int infinite = static_cast<int>(sites.size());
+    int t = last;
+    for (;;) {
+        const Triangle& triangle = triangles[t];
+        int next = NONE;
+        for (int i = 0; i < 3 && next == NONE; ++i) {
+            const int a = triangle.v[(i + 1) % 3];
+            const int b = triangle.v[(i + 2) % 3];
+            if (triangle.v[i] == infinite) {
+                next = (orientation(a, b, vertex) > 0) ? NONE : triangle.adj[i];
+                break;
+            }
+            if (a != infinite && b != infinite && orientation(a, b, vertex) < 0) {
+                next = triangle.adj[i];
+            }
+        }
+        if (next == NONE) {
+            break;
+        }
+        t = next;
+    }
+    // Cavité : les triangles voisins dont le cercle circonscrit contient le point
+    stamp++;
+    marks[t] = stamp;
+    cavity.assign(1, t);
+    stack.assign(1, t);
+    while (!stack.empty()) {
+        const int current = stack.back();
+        stack.pop_back();
+        for (int neighbour : triangles[current].adj) {
+            if (marks[neighbour] != stamp && inCircumcircle(triangles[neighbour], vertex)) {
+                marks[neighbour] = stamp;
+                cavity.push_back(neighbour);
+                stack.push_back(neighbour);
+            }
+        }
+    }
+
+    // Bord de la cavité, relevé avant d'écraser quoi que ce soit
+    boundary.clear();
+    for (int current : cavity) {
+        const Triangle& triangle = triangles[current];
+        for (int i = 0; i < 3; ++i) {
+            const int outer = triangle.adj[i];
+            if (marks[outer] != stamp) {
+                int outerSide = 0;
+                while (triangles[outer].adj[outerSide] != current) {
+                    outerSide++;
+                }
+                boundary.push_back({triangle.v[(i + 1) % 3], triangle.v[(i + 2) % 3], outer, outerSide});
+            }
+        }
+    }
+
+    // Un triangle (point, a, b) par côté du bord, dans les places de la cavité
+    // puis deux de plus
+    for (size_t k = 0; k < boundary.size(); ++k) {
+        const Edge& edge = boundary[k];
+        int slot;
+        if (k < cavity.size()) {
+            slot = cavity[k];
+        } else {
+            slot = static_cast<int>(triangles.size());
+            triangles.push_back(Triangle());
+            marks.push_back(stamp);
+        }
+        triangles[slot] = Triangle{{vertex, edge.a, edge.b}, {edge.outer, NONE, NONE}};
+        triangles[edge.outer].adj[edge.outerSide] = slot;
+        byFirst[edge.a] = slot;
+    }
+    // Le bord est un cycle : le voisin de (point, a, b) côté b est (point, b, c)
+    for (size_t k = 0; k < boundary.size(); ++k) {
+        const int slot = byFirst[boundary[k].a];
+        const int following = byFirst[boundary[k].b];
+        triangles[slot].adj[1] = following;
+        triangles[following].adj[2] = slot;
+    }
+    last = byFirst[boundary[0].a];
+}
+
+int DelaunayLocator::walk(const sf::Vector2f& position, int current) const {
+    double best = squaredDistance(sites[current], position);
+    for (;;) {
+        int next = current;
+        for (int e = offsets[current]; e < offsets[current + 1]; ++e) {
+            const double distance = squaredDistance(sites[neighbours[e]], position);
+            if (distance < best) {
+                best = distance;
+                next = neighbours[e];
+            }
+        }
+        if (next == current) {
+            return current;
+        }
+        current = next;
+    }
+}
+
+void DelaunayLocator::save(SnapshotWriter& writer) const {
+    writer.addValue(Snapshot::DELAUNAY, Header{box.left, box.top, box.width, box.height, side});
+    writer.add(Snapshot::DELAUNAY_SITES, sites.data(), sites.size());
+    writer.add(Snapshot::DELAUNAY_OFFSETS, offsets.data(), offsets.size());
+    writer.add(Snapshot::DELAUNAY_NEIGHBOURS, neighbours.data(), neighbours.size());
+    writer.add(Snapshot::DELAUNAY_GRID, grid.data(), grid.size());
+}
+
+bool DelaunayLocator::load(const std::shared_ptr<const Snapshot>& snapshot) {
+    size_t headers = 0;
+    const Header* header = snapshot->get<Header>(Snapshot::DELAUNAY, headers);
+    MappedArray<sf::Vector2f> loadedSites;
+    MappedArray<int> loadedOffsets, loadedNeighbours, loadedGrid;
+    if (header == nullptr || headers != 1 || !loadedSites.map(snapshot, Snapshot::DELAUNAY_SITES) ||
+        !loadedOffsets.map(snapshot, Snapshot::DELAUNAY_OFFSETS) ||
+        !loadedNeighbours.map(snapshot, Snapshot::DELAUNAY_NEIGHBOURS) ||
+        !loadedGrid.map(snapshot, Snapshot::DELAUNAY_GRID)) {
+        return false;
+    }
+    const size_t siteCount = loadedSites.size(), neighbourCount = loadedNeighbours.size();
+    if (loadedOffsets.size() != siteCount + 1 || siteCount > static_cast<size_t>(std::numeric_limits<int>::max()) ||
+        header->side < 0 || (header->side == 0) != (siteCount == 0) ||
+        loadedGrid.size() != static_cast<size_t>(header->side) * header->side || !std::isfinite(header->left) ||
+        !std::isfinite(header->top) || !std::isfinite(header->width) || !std::isfinite(header->height)) {
+        return false;
+    }
+    const int n = static_cast<int>(siteCount);
+    if (loadedOffsets.at(0) != 0 || loadedOffsets.at(n) < 0 ||
+        static_cast<size_t>(loadedOffsets.at(n)) > neighbourCount) {
+        return false;
+    }
+    // Tout indice lu doit désigner un site : les voisins de chaque site sont
+    // une tranche croissante de neighbours
+    if (snapshot->check() == Snapshot::FULL) {
+        for (int i = 0; i < n; ++i) {
+            if (loadedOffsets.at(i) > loadedOffsets.at(i + 1)) {
+                return false;
+            }
+        }
+        auto isSite = [n](int index) { return index >= 0 && index < n; };
+        const int* neighbourData = loadedNeighbours.data();
+        const int* gridData = loadedGrid.data();
+        if (!std::all_of(neighbourData, neighbourData + neighbourCount, isSite) ||
+            !std::all_of(gridData, gridData + loadedGrid.size(), isSite)) {
+            return false;
+        }
+    }
+    box = sf::FloatRect(header->left, header->top, header->width, header->height);
+    side = header->side;
+    sites = std::move(loadedSites);
+    offsets = std::move(loadedOffsets);
+    neighbours = std::move(loadedNeighbours);
+    grid = std::move(loadedGrid);
+    return true;
+}
+
+int DelaunayLocator::nearest(const sf::Vector2f& position, int hint) const {
+    if (sites.empty()) {
+        return NONE;
+    }
+    if (hint < 0 || hint >= static_cast<int>(sites.size())) {
+        int x = static_cast<int>((position.x - box.left) * side / std::max(box.width, 1e-6f));
+        int y = static_cast<int>((position.y - box.top) * side / std::max(box.height, 1e-6f));
+        x = std::min(std::max(x, 0), side - 1);
+        y = std::min(std::max(y, 0), side - 1);
+        hint = grid[y * side + x];
+    }
+    return walk(position, hint);
+}
@@ -0,0 +1,94 @@
+#ifndef DELAUNAY_HPP
+#define DELAUNAY_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "snapshot.hpp"
+
+// Plus proche site par marche sur la triangulation de Delaunay des packs de
+// soin. Depuis n'importe quel site, passer au voisin de Delaunay le plus
+// proche de la requête tant qu'il en existe un plus proche mène toujours au
+// plus proche site. Une unité repart de sa réponse précédente : comme elle a
+// peu bougé, la marche ne fait que quelques pas, O(1) amorti. Sans réponse
+// précédente, une grille grossière fournit le point de départ.
+class DelaunayLocator {
+public:
+    static const int NONE = -1;
+
+    DelaunayLocator();
+
+    // Triangule les sites par Bowyer-Watson, insérés le long d'une courbe de
+    // Morton. Les doublons ne sont gardés qu'une fois. Les tampons sont gardés
+    // d'un appel à l'autre.
+    void build(const std::vector<sf::Vector2f>& positions);
+    size_t size() const { return sites.size(); }
+    // Les indices sont ceux du locator, pas ceux passés à build
+    const sf::Vector2f& site(int index) const { return sites[index]; }
+
+    // Indice du plus proche site en partant de `hint`, la réponse précédente
+    // pour la même unité. Un hint à NONE ou invalide (après un build) repart
+    // de la grille. NONE s'il n'y a aucun site
+    int nearest(const sf::Vector2f& position, int hint = NONE) const;
+
+    // Sites, graphe et grille de départ, sans les tampons de construction.
+    // load() les lit en place jusqu'au prochain build ; il rend false si une
+    // section manque ou si les tailles ne correspondent pas, O(1), ou avec
+    // Snapshot::FULL si un indice est hors bornes, O(n)
+    void save(SnapshotWriter& writer) const;
+    bool load(const std::shared_ptr<const Snapshot>& snapshot);
+
+private:
+    struct Triangle {
+        int v[3];   // sommets dans le sens trigonométrique
+        int adj[3]; // adj[i] : triangle de l'autre côté de l'arête opposée à v[i]
+    };
+
+    struct Header {
+        float left, top, width, height; // box
+        int32_t side;
+    };
+
+    // Côté de la cavité à retrianguler autour du point inséré
+    struct Edge {
+        int a, b;
+        int outer;     // triangle de l'autre côté
+        int outerSide; // indice de l'arête dans outer
+    };
+
+    bool triangulate();
+    void insert(int vertex, int& last);
+    bool inCircumcircle(const Triangle& triangle, int vertex) const;
+    double orientation(int a, int b, int c) const;
+    // Arête réelle (a, b) d'un triangle fantôme, le sommet à l'infini à sa gauche
+    void ghostEdge(const Triangle& triangle, int& a, int& b) const;
+    int walk(const sf::Vector2f& position, int from) const;
+
+    // Sites rangés le long de la courbe de Morton, et leurs voisins de
+    // Delaunay : neighbours[offsets[i] .. offsets[i + 1]]
+    MappedArray<sf::Vector2f> sites;
+    MappedArray<int> offsets;
+    MappedArray<int> neighbours;
+
+    // Grille de départ : le plus proche site du centre de chaque case
+    sf::FloatRect box;
+    int side;
+    MappedArray<int> grid;
+
+    // Tampons de construction. Le sommet d'indice size() est à l'infini : les
+    // triangles « fantômes » qui l'ont pour sommet bordent l'enveloppe
+    // convexe, sans les erreurs d'arrondi d'un super triangle fini
+    std::vector<sf::Vector2<double>> points;
+    std::vector<Triangle> triangles;
+    std::vector<int> marks; // marks[t] == stamp : t est dans la cavité courante
+    int stamp;
+    std::vector<int> cavity;
+    std::vector<int> stack;
+    std::vector<Edge> boundary;
+    std::vector<int> byFirst; // nouveau triangle (p, a, b) de chaque sommet a de la cavité
+    std::vector<std::pair<uint32_t, int>> order;
+};
+
+#endif // DELAUNAY_HPP
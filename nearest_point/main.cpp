@@ -1,7 +1,20 @@
 #include "voronoi.hpp"
+#include <string>
 
+// Usage: ./voronoi [--check] [map.snap]
+// --check vérifie toute la carte, sommes de contrôle et index, en O(n)
 int main(int argc, char const* argv[]) {
-    Voronoi voronoi(1920, 1080, 30);
+    // Monde de 10 x 10 écrans, 30 sites par écran
+    Voronoi voronoi(1920, 1080, 10, 3000);
+    int argument = 1;
+    Snapshot::Check check = Snapshot::QUICK;
+    if (argc > argument && std::string(argv[argument]) == "--check") {
+        check = Snapshot::FULL;
+        argument++;
+    }
+    if (argc > argument && !voronoi.load(argv[argument], check)) {
+        return EXIT_FAILURE;
+    }
 
     if (!voronoi.initialize()) {
         return EXIT_FAILURE;
@@ -0,0 +1,119 @@
+#include "nearest_batch.hpp"
+#include <algorithm>
+
+namespace {
+
+// Intercale les 8 bits bas de v avec des zéros
+uint32_t spread(uint32_t v) {
+    v &= 0xff;
+    v = (v | (v << 4)) & 0x0f0f;
+    v = (v | (v << 2)) & 0x3333;
+    v = (v | (v << 1)) & 0x5555;
+    return v;
+}
+
+}
+
+NearestBatch::NearestBatch(ThreadPool& pool)
+    : pool(pool), offsets(static_cast<size_t>(pool.size()) * BUCKETS) {}
+
+void NearestBatch::run(const Quadtree& quadtree, const sf::Vector2f* positions, size_t count, Point* results) {
+    const Pass pass = prepare(quadtree.bounds(), &quadtree, nullptr, positions, results, count);
+    sort(pass);
+
+    // Chaque requête part du résultat de la précédente, toute proche
+    pool.parallelFor(pass.chunks(), [this, &pass](size_t chunk) {
+        const size_t end = std::min(pass.count, (chunk + 1) * CHUNK);
+        Point previous;
+        bool hasPrevious = false;
+        for (size_t j = chunk * CHUNK; j < end; ++j) {
+            const Query& query = sorted[j];
+            Point& result = pass.results[query.index];
+            if (hasPrevious) {
+                result = pass.quadtree->nearestFrom(previous, query.position);
+            } else {
+                result = Point{query.position, false};
+                hasPrevious = pass.quadtree->nearest(query.position, result);
+            }
+            previous = result;
+        }
+    });
+}
+
+void NearestBatch::run(NearestRaster& raster, const sf::Vector2f* positions, size_t count, Point* results) {
+    // Les tuiles marquées sont refaites ici, une fois : les tâches ne font
+    // ensuite que lire
+    raster.refresh();
+    const Pass pass = prepare(raster.area(), nullptr, &raster, positions, results, count);
+
+    // Tant que la grille tient en cache, le tri coûte plus qu'il ne rend
+    if (raster.tileCount() <= BUCKETS) {
+        pool.parallelFor(pass.chunks(), [&pass](size_t chunk) {
+            for (size_t i = chunk * CHUNK, end = std::min(pass.count, (chunk + 1) * CHUNK); i < end; ++i) {
+                pass.results[i] = Point{pass.positions[i], false};
+                pass.raster->nearest(pass.positions[i], pass.results[i]);
+            }
+        });
+        return;
+    }
+
+    // Rangées, des requêtes voisines lisent les mêmes tuiles
+    sort(pass);
+    pool.parallelFor(pass.chunks(), [this, &pass](size_t chunk) {
+        for (size_t j = chunk * CHUNK, end = std::min(pass.count, (chunk + 1) * CHUNK); j < end; ++j) {
+            const Query& query = sorted[j];
+            Point& result = pass.results[query.index];
+            result = Point{query.position, false};
+            pass.raster->nearest(query.position, result);
+        }
+    });
+}
+
+NearestBatch::Pass NearestBatch::prepare(const sf::FloatRect& bounds, const Quadtree* quadtree, const NearestRaster* raster,
+                                         const sf::Vector2f* positions, Point* results, size_t count) {
+    cells.resize(count);
+    sorted.resize(count);
+    const size_t chunks = (count + CHUNK - 1) / CHUNK;
+    const int side = 1 << LEVELS;
+    return Pass{quadtree, raster, positions, results, count, std::max<size_t>(1, std::min<size_t>(pool.size(), chunks)),
+                bounds.left, bounds.top, side / bounds.width, side / bounds.height};
+}
+
+void NearestBatch::sort(const Pass& pass) {
+    // Tri par dénombrement, O(n), en trois passes : chaque bloc de requêtes
+    // compte ses cases dans son propre histogramme, une passe courte de
+    // BUCKETS x blocs en tire la première place de chaque case dans chaque
+    // bloc, puis chaque bloc range ses requêtes. Le tri reste stable.
+    // Les tâches ne capturent que this et pass : std::function les garde
+    // alors sans allouer
+
+    // Case de Morton de chaque requête dans les bornes de l'index
+    pool.parallelFor(pass.blocks, [this, &pass](size_t block) {
+        uint32_t* histogram = &offsets[block * BUCKETS];
+        std::fill(histogram, histogram + BUCKETS, 0);
+        for (size_t i = pass.begin(block), end = pass.begin(block + 1); i < end; ++i) {
+            int x = static_cast<int>((pass.positions[i].x - pass.left) * pass.scaleX);
+            int y = static_cast<int>((pass.positions[i].y - pass.top) * pass.scaleY);
+            x = std::min(std::max(x, 0), (1 << LEVELS) - 1);
+            y = std::min(std::max(y, 0), (1 << LEVELS) - 1);
+            cells[i] = spread(x) | (spread(y) << 1);
+            histogram[cells[i]]++;
+        }
+    });
+
+    uint32_t total = 0;
+    for (size_t cell = 0; cell < BUCKETS; ++cell) {
+        for (size_t block = 0; block < pass.blocks; ++block) {
+            const uint32_t n = offsets[block * BUCKETS + cell];
+            offsets[block * BUCKETS + cell] = total;
+            total += n;
+        }
+    }
+
+    pool.parallelFor(pass.blocks, [this, &pass](size_t block) {
+        uint32_t* heads = &offsets[block * BUCKETS];
+        for (size_t i = pass.begin(block), end = pass.begin(block + 1); i < end; ++i) {
+            sorted[heads[cells[i]]++] = Query{pass.positions[i], static_cast<uint32_t>(i)};
+        }
+    });
+}
@@ -0,0 +1,233 @@
+#include "nearest_raster.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+float squaredDistance(const sf::Vector2f& a, const sf::Vector2f& b) {
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+// Un point de la case [left, right] x [top, bottom] peut-il être plus près
+// de s que de a ? La différence des carrés des distances est affine : il
+// suffit de regarder les coins. `tolerance` couvre les arrondis des requêtes
+bool closerSomewhere(const sf::Vector2f& s, const sf::Vector2f& a, double left, double top, double right,
+                     double bottom, double tolerance) {
+    const double cornersX[2] = {left, right};
+    const double cornersY[2] = {top, bottom};
+    for (double x : cornersX) {
+        for (double y : cornersY) {
+            double sx = s.x - x, sy = s.y - y;
+            double ax = a.x - x, ay = a.y - y;
+            if (sx * sx + sy * sy - (ax * ax + ay * ay) <= tolerance) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}
+
+NearestRaster::NearestRaster(sf::FloatRect bounds, float cellSize)
+    : bounds(bounds), sites(bounds) {
+    resize(cellSize);
+}
+
+void NearestRaster::resize(float size) {
+    cellSize = size;
+    scale = 1.f / size;
+    columns = std::max(1, static_cast<int>(std::ceil(bounds.width * scale)));
+    rows = std::max(1, static_cast<int>(std::ceil(bounds.height * scale)));
+    tileColumns = (columns + TILE - 1) / TILE;
+    tileRows = (rows + TILE - 1) / TILE;
+    tiles.resize(tileColumns * tileRows);
+    for (auto& tile : tiles) {
+        tile.dirty = true;
+    }
+    reach = 0.f;
+}
+
+void NearestRaster::build(const std::vector<Point>& points) {
+    sites.clear();
+    size_t packs = 0;
+    for (const auto& point : points) {
+        sites.insert(point);
+        packs += point.hasHealthPack;
+    }
+    resize(std::sqrt(bounds.width * bounds.height / (std::max<size_t>(packs, 1) * CELLS_PER_PACK)));
+}
+
+int NearestRaster::insert(const Point& point) {
+    if (point.hasHealthPack) {
+        invalidate(point.position);
+    }
+    return sites.insert(point);
+}
+
+void NearestRaster::remove(int id) {
+    const Point& point = sites.point(id);
+    if (point.hasHealthPack) {
+        invalidate(point.position);
+    }
+    sites.remove(id);
+}
+
+void NearestRaster::invalidate(const sf::Vector2f& position) {
+    // Le pack n'est candidat d'une case qu'à moins de sa portée du centre :
+    // on compare à la boîte des centres de chaque tuile à portée et à sa plus
+    // grande portée
+    const float half = cellSize / 2.f;
+    const float side = TILE * cellSize;
+    int left = 0, top = 0, right = tileColumns - 1, bottom = tileRows - 1;
+    if (reach < std::numeric_limits<float>::infinity()) {
+        left = std::max(left, static_cast<int>((position.x - reach - bounds.left) / side) - 1);
+        top = std::max(top, static_cast<int>((position.y - reach - bounds.top) / side) - 1);
+        right = std::min(right, static_cast<int>((position.x + reach - bounds.left) / side) + 1);
+        bottom = std::min(bottom, static_cast<int>((position.y + reach - bounds.top) / side) + 1);
+    }
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            Tile& tile = tiles[y * tileColumns + x];
+            if (tile.dirty) {
+                continue;
+            }
+            const float x0 = bounds.left + x * side + half;
+            const float y0 = bounds.top + y * side + half;
+            float dx = std::max(std::max(x0 - position.x, position.x - (x0 + side - cellSize)), 0.f);
+            float dy = std::max(std::max(y0 - position.y, position.y - (y0 + side - cellSize)), 0.f);
+            if (dx * dx + dy * dy <= tile.reach * tile.reach) {
+                tile.dirty = true;
+            }
+        }
+    }
+}
+
+// Pour chaque case, a le plus proche pack du centre, à d1. Tout point de la
+// case est à moins de d1 + h de a, h la demi-diagonale, donc seuls les packs
+// à moins de d1 + 2h du centre, sa portée, peuvent le battre ; on ne garde
+// que ceux qui sont plus près que a en au moins un coin
+void NearestRaster::rebuild(int index) {
+    Tile& tile = tiles[index];
+    const int x0 = (index % tileColumns) * TILE;
+    const int y0 = (index / tileColumns) * TILE;
+    const int x1 = std::min(x0 + TILE, columns);
+    const int y1 = std::min(y0 + TILE, rows);
+    const float halfDiagonal = cellSize * 0.70710678f;
+
+    tile.offsets.assign(TILE * TILE + 1, 0);
+    tile.candidates.clear();
+    tile.dirty = false;
+    tile.reach = 0.f;
+    Point hint;
+    const sf::Vector2f middle(bounds.left + (x0 + x1) * cellSize / 2.f, bounds.top + (y0 + y1) * cellSize / 2.f);
+    if (!sites.nearest(middle, hint)) {
+        tile.reach = reach = std::numeric_limits<float>::infinity();
+        return;
+    }
+
+    // Un centre c de la tuile est à moins de `corner` du milieu m : d1(c) <=
+    // d1(m) + corner, et tout pack à portée de c est à moins de
+    // d1(m) + 2 corner + 2h de m. Une seule recherche pour toute la tuile
+    const float corner = std::sqrt(squaredDistance(middle, sf::Vector2f(bounds.left + (x0 + 0.5f) * cellSize,
+                                                                        bounds.top + (y0 + 0.5f) * cellSize)));
+    const float radius = std::sqrt(squaredDistance(hint.position, middle)) + 2.f * (corner + halfDiagonal);
+    found.clear();
+    sites.withinRadius(middle, radius * 1.0001f, found);
+
+    for (int cell = 0; cell < TILE * TILE; ++cell) {
+        tile.offsets[cell] = static_cast<uint32_t>(tile.candidates.size());
+        const int x = x0 + cell % TILE, y = y0 + cell / TILE;
+        if (x >= x1 || y >= y1) {
+            continue;
+        }
+        const float left = bounds.left + x * cellSize;
+        const float top = bounds.top + y * cellSize;
+        const sf::Vector2f center(left + cellSize / 2.f, top + cellSize / 2.f);
+
+        size_t nearest = 0;
+        float best = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < found.size(); ++i) {
+            float distance = squaredDistance(found[i].position, center);
+            if (distance < best) {
+                nearest = i;
+                best = distance;
+            }
+        }
+        const sf::Vector2f& a = found[nearest].position;
+        const float cellReach = std::sqrt(best) + 2.f * halfDiagonal;
+        const double tolerance = 1e-5 * cellReach * cellReach;
+        tile.reach = std::max(tile.reach, cellReach);
+
+        tile.candidates.push_back(found[nearest]);
+        for (const auto& point : found) {
+            if (point.position != a && squaredDistance(point.position, center) <= cellReach * cellReach &&
+                closerSomewhere(point.position, a, left, top, left + cellSize, top + cellSize, tolerance)) {
+                tile.candidates.push_back(point);
+            }
+        }
+    }
+    tile.offsets[TILE * TILE] = static_cast<uint32_t>(tile.candidates.size());
+    reach = std::max(reach, tile.reach);
+}
+
+bool NearestRaster::nearest(const sf::Vector2f& position, Point& result) {
+    if (bounds.contains(position)) {
+        const int x = std::min(static_cast<int>((position.x - bounds.left) * scale), columns - 1);
+        const int y = std::min(static_cast<int>((position.y - bounds.top) * scale), rows - 1);
+        const int index = (y / TILE) * tileColumns + x / TILE;
+        if (tiles[index].dirty) {
+            rebuild(index);
+        }
+    }
+    return static_cast<const NearestRaster&>(*this).nearest(position, result);
+}
+
+bool NearestRaster::nearest(const sf::Vector2f& position, Point& result) const {
+    if (!bounds.contains(position)) {
+        return sites.nearest(position, result);
+    }
+    const int x = std::min(static_cast<int>((position.x - bounds.left) * scale), columns - 1);
+    const int y = std::min(static_cast<int>((position.y - bounds.top) * scale), rows - 1);
+    const int index = (y / TILE) * tileColumns + x / TILE;
+    if (tiles[index].dirty) {
+        return sites.nearest(position, result);
+    }
+
+    const Tile& tile = tiles[index];
+    const int cell = (y % TILE) * TILE + x % TILE;
+    const uint32_t begin = tile.offsets[cell], end = tile.offsets[cell + 1];
+    if (begin == end) {
+        return false;
+    }
+    uint32_t best = begin;
+    float bestDistance = squaredDistance(tile.candidates[begin].position, position);
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        float distance = squaredDistance(tile.candidates[i].position, position);
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    result = tile.candidates[best];
+    return true;
+}
+
+void NearestRaster::refresh() {
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (tiles[i].dirty) {
+            rebuild(static_cast<int>(i));
+        }
+    }
+}
+
+size_t NearestRaster::dirtyTiles() const {
+    size_t count = 0;
+    for (const auto& tile : tiles) {
+        count += tile.dirty;
+    }
+    return count;
+}
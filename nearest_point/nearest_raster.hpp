@@ -0,0 +1,68 @@
+#ifndef NEAREST_RASTER_HPP
+#define NEAREST_RASTER_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "quadtree.hpp"
+
+// Plus proche pack en O(1) pour un ensemble de packs qui change peu. Une
+// grille basse résolution garde pour chaque case les seuls packs qui peuvent
+// être le plus proche d'un point de la case : un seul loin des arêtes du
+// diagramme de Voronoï, deux ou trois sur une arête. Une requête lit la case
+// puis compare les distances à ces quelques candidats.
+// Les cases sont groupées en tuiles de TILE x TILE. Un ajout ou un retrait
+// ne marque que les tuiles dont une case peut changer, reconstruites à la
+// première requête qui y tombe.
+class NearestRaster {
+public:
+    NearestRaster(sf::FloatRect bounds, float cellSize);
+
+    // Remplace tous les points, d'identifiants leurs indices. La taille des
+    // cases suit la densité des packs, environ CELLS_PER_PACK cases par pack
+    void build(const std::vector<Point>& points);
+    // Identifiant du point, stable jusqu'à son retrait
+    int insert(const Point& point);
+    void remove(int id);
+
+    // Plus proche pack, false s'il n'y en a aucun. Reconstruit la tuile de
+    // `position` si besoin : pas d'appels concurrents sans refresh() avant
+    bool nearest(const sf::Vector2f& position, Point& result);
+    // Idem sans rien reconstruire, une tuile marquée répond par le quadtree :
+    // sûr pour des appels concurrents, à pleine vitesse après refresh()
+    bool nearest(const sf::Vector2f& position, Point& result) const;
+    // Reconstruit toutes les tuiles marquées
+    void refresh();
+    size_t dirtyTiles() const;
+    size_t tileCount() const { return tiles.size(); }
+    // Rectangle couvert par la grille ; au-dehors, nearest passe au quadtree
+    const sf::FloatRect& area() const { return bounds; }
+
+private:
+    static const int TILE = 4;
+    static const int CELLS_PER_PACK = 4;
+
+    struct Tile {
+        bool dirty;
+        float reach; // au-delà, un nouveau pack ne change aucune case de la tuile
+        std::vector<uint32_t> offsets; // candidats de la case c : [offsets[c], offsets[c + 1])
+        std::vector<Point> candidates;
+    };
+
+    void resize(float cellSize);
+    // Marque les tuiles où un pack à `position` est ou serait candidat
+    void invalidate(const sf::Vector2f& position);
+    void rebuild(int tile);
+
+    sf::FloatRect bounds;
+    float cellSize;
+    float scale; // cases par unité
+    int columns, rows;         // en cases
+    int tileColumns, tileRows; // en tuiles
+    std::vector<Tile> tiles;
+    float reach; // plus grande portée d'une tuile depuis resize
+    Quadtree sites;
+    std::vector<Point> found; // tampon de rebuild
+};
+
+#endif // NEAREST_RASTER_HPP
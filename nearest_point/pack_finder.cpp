@@ -0,0 +1,41 @@
+#include "pack_finder.hpp"
+#include <algorithm>
+
+PackFinder::PackFinder(const Quadtree& quadtree) : quadtree(quadtree), stale(true), queries(0) {}
+
+void PackFinder::changed() {
+    stale = true;
+    queries = 0;
+}
+
+Point PackFinder::nearest(const sf::Vector2f& position, int& hint) {
+    if (stale && ++queries >= std::max<size_t>(quadtree.available(), 1)) {
+        quadtree.packs(positions);
+        locator.build(positions);
+        stale = false;
+    }
+
+    if (stale) {
+        hint = DelaunayLocator::NONE;
+        Point result{position, false};
+        quadtree.nearest(position, result);
+        return result;
+    }
+    hint = locator.nearest(position, hint);
+    if (hint == DelaunayLocator::NONE) {
+        return {position, false};
+    }
+    return {locator.site(hint), true};
+}
+
+void PackFinder::save(SnapshotWriter& writer) const {
+    if (!stale) {
+        locator.save(writer);
+    }
+}
+
+bool PackFinder::load(const std::shared_ptr<const Snapshot>& snapshot) {
+    queries = 0;
+    stale = !locator.load(snapshot);
+    return !stale;
+}
@@ -0,0 +1,44 @@
+#ifndef PACK_FINDER_HPP
+#define PACK_FINDER_HPP
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "delaunay.hpp"
+#include "quadtree.hpp"
+
+// Plus proche pack disponible pour des unités qui bougent peu d'une requête
+// à l'autre, le chemin de l'application. Tant que les packs ne changent pas,
+// la triangulation des packs répond par une marche depuis la réponse
+// précédente de l'unité, O(1) amorti. Un changement (site avec pack ajouté,
+// retiré ou tiré, pack ramassé ou réapparu) la périme sans la refaire : le
+// quadtree répond alors, en sautant les sous-arbres sans pack. Elle n'est
+// refaite qu'après autant de requêtes depuis le dernier changement que de
+// packs, quand ces requêtes ont coûté à peu près une triangulation : un site
+// tiré à chaque image ne coûte jamais de triangulation.
+class PackFinder {
+public:
+    explicit PackFinder(const Quadtree& quadtree);
+
+    // Les packs du quadtree ont changé. O(1)
+    void changed();
+    // Plus proche pack disponible de `position`, un point sans pack s'il n'y
+    // en a aucun. `hint` : la réponse précédente de la même unité,
+    // DelaunayLocator::NONE au départ, mise à jour par l'appel
+    Point nearest(const sf::Vector2f& position, int& hint);
+
+    // La triangulation, seulement si elle est à jour ; load() la reprend
+    // telle quelle, lue en place, false si elle manque ou est incohérente
+    void save(SnapshotWriter& writer) const;
+    bool load(const std::shared_ptr<const Snapshot>& snapshot);
+
+private:
+    const Quadtree& quadtree;
+    DelaunayLocator locator;
+    bool stale;
+    size_t queries; // depuis le dernier changement
+    std::vector<sf::Vector2f> positions; // tampon de la triangulation
+};
+
+#endif // PACK_FINDER_HPP
@@ -0,0 +1,576 @@
+#include "quadtree.hpp"
+#include "snapshot.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace {
+
+float squaredDistance(const sf::Vector2f& a, const sf::Vector2f& b) {
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+// Nœud et point tels qu'écrits dans le snapshot, mot de 32 bits par mot :
+// la disposition de Node et Slot, lus en place, remplissage à zéro compris
+struct NodeRecord {
+    float left, top, width, height;
+    float extentLeft, extentTop, extentRight, extentBottom;
+    int32_t children, first, parent, count, live;
+};
+
+struct SlotRecord {
+    float x, y;
+    uint8_t pack, zero[3];
+    int32_t next, leaf;
+};
+
+static_assert(sizeof(NodeRecord) == 13 * 4 && sizeof(SlotRecord) == 5 * 4, "snapshot records must have no padding");
+
+// Boîte élargie de la moitié de sa taille de chaque côté
+bool looselyContains(const sf::FloatRect& box, const sf::Vector2f& position) {
+    return position.x >= box.left - box.width / 2.f && position.x <= box.left + 1.5f * box.width &&
+           position.y >= box.top - box.height / 2.f && position.y <= box.top + 1.5f * box.height;
+}
+
+}
+
+Quadtree::Quadtree(sf::FloatRect bounds) : freeChildren(NONE), freeSlots(NONE) {
+    nodes.assign(1, Node{bounds, Extent(), NONE, NONE, NONE, 0, 0});
+}
+
+void Quadtree::clear() {
+    // Les tableaux gardent leur capacité pour les prochaines insertions
+    const sf::FloatRect bounds = nodes[0].bounds;
+    nodes.assign(1, Node{bounds, Extent(), NONE, NONE, NONE, 0, 0});
+    slots.clear();
+    freeChildren = NONE;
+    freeSlots = NONE;
+}
+
+void Quadtree::save(SnapshotWriter& writer) const {
+    std::vector<NodeRecord> nodeRecords(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        nodeRecords[i] = NodeRecord{node.bounds.left, node.bounds.top, node.bounds.width, node.bounds.height,
+                                    node.extent.left, node.extent.top, node.extent.right, node.extent.bottom,
+                                    node.children, node.first, node.parent, node.count, node.live};
+    }
+    std::vector<SlotRecord> slotRecords(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const Slot& slot = slots[i];
+        slotRecords[i] = SlotRecord{slot.point.position.x, slot.point.position.y,
+                                    static_cast<uint8_t>(slot.point.hasHealthPack), {0, 0, 0}, slot.next, slot.leaf};
+    }
+
+    const int32_t lists[2] = {freeChildren, freeSlots};
+    writer.addValue(Snapshot::QUADTREE, lists);
+    writer.addCopy(Snapshot::QUADTREE_NODES, nodeRecords);
+    writer.addCopy(Snapshot::QUADTREE_SLOTS, slotRecords);
+}
+
+bool Quadtree::load(const std::shared_ptr<const Snapshot>& snapshot) {
+    static_assert(sizeof(Node) == sizeof(NodeRecord) && offsetof(Node, extent) == offsetof(NodeRecord, extentLeft) &&
+                      offsetof(Node, children) == offsetof(NodeRecord, children) &&
+                      offsetof(Node, live) == offsetof(NodeRecord, live),
+                  "nodes must be readable in place");
+    static_assert(sizeof(Slot) == sizeof(SlotRecord) && sizeof(bool) == 1 &&
+                      offsetof(Slot, point) + offsetof(Point, hasHealthPack) == offsetof(SlotRecord, pack) &&
+                      offsetof(Slot, next) == offsetof(SlotRecord, next) &&
+                      offsetof(Slot, leaf) == offsetof(SlotRecord, leaf),
+                  "slots must be readable in place");
+
+    size_t listCount = 0;
+    const int32_t* lists = snapshot->get<int32_t>(Snapshot::QUADTREE, listCount);
+    MappedArray<Node> loadedNodes;
+    MappedArray<Slot> loadedSlots;
+    if (lists == nullptr || listCount != 2 || !loadedNodes.map(snapshot, Snapshot::QUADTREE_NODES) ||
+        !loadedSlots.map(snapshot, Snapshot::QUADTREE_SLOTS)) {
+        return false;
+    }
+
+    // Tailles seulement : des blocs de 4 nœuds après la racine, des têtes de
+    // liste dans les bornes
+    const size_t maxCount = static_cast<size_t>(std::numeric_limits<int>::max());
+    const size_t nodeCount = loadedNodes.size(), slotCount = loadedSlots.size();
+    if (nodeCount == 0 || nodeCount > maxCount || (nodeCount - 1) % 4 != 0 || slotCount > maxCount ||
+        lists[0] < NONE || lists[0] >= static_cast<int>(nodeCount) || lists[1] < NONE ||
+        lists[1] >= static_cast<int>(slotCount) || loadedNodes.at(0).count < 0 ||
+        static_cast<size_t>(loadedNodes.at(0).count) > slotCount) {
+        return false;
+    }
+    if (snapshot->check() == Snapshot::FULL) {
+        // Un booléen lu en place doit valoir 0 ou 1
+        size_t recordCount = 0;
+        const SlotRecord* records = snapshot->get<SlotRecord>(Snapshot::QUADTREE_SLOTS, recordCount);
+        for (size_t i = 0; i < recordCount; ++i) {
+            if (records[i].pack > 1) {
+                return false;
+            }
+        }
+        if (!consistent(loadedNodes, loadedSlots, lists[0], lists[1])) {
+            return false;
+        }
+    }
+
+    nodes = std::move(loadedNodes);
+    slots = std::move(loadedSlots);
+    freeChildren = lists[0];
+    freeSlots = lists[1];
+    return true;
+}
+
+bool Quadtree::consistent(const MappedArray<Node>& nodes, const MappedArray<Slot>& slots, int freeChildren,
+                          int freeSlots) {
+    const int nodeCount = static_cast<int>(nodes.size());
+    const int slotCount = static_cast<int>(slots.size());
+    // Un bloc de 4 enfants commence après la racine, sur un multiple de 4
+    auto isBlock = [&](int children) {
+        return children >= 1 && (children - 1) % 4 == 0 && children <= nodeCount - 4;
+    };
+    const sf::FloatRect& root = nodes[0].bounds;
+    if (nodes[0].parent != NONE || !std::isfinite(root.left) || !std::isfinite(root.top) ||
+        !std::isfinite(root.width) || !std::isfinite(root.height) || !(root.width > 0.f) || !(root.height > 0.f)) {
+        return false;
+    }
+
+    // Parcours en largeur depuis la racine : chaque parent avant ses enfants
+    std::vector<char> seenNodes(nodeCount, 0), seenSlots(slotCount, 0);
+    std::vector<int> order(1, 0);
+    seenNodes[0] = 1;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const int node = order[i];
+        const Node& current = nodes[node];
+        if (current.children == NONE) {
+            Extent extent;
+            int count = 0, live = 0;
+            for (int slot = current.first; slot != NONE; slot = slots[slot].next) {
+                if (slot < 0 || slot >= slotCount || seenSlots[slot] || slots[slot].leaf != node) {
+                    return false;
+                }
+                seenSlots[slot] = 1;
+                extent.add(slots[slot].point.position);
+                count++;
+                live += slots[slot].point.hasHealthPack;
+            }
+            if (count != current.count || live != current.live || !(extent == current.extent)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (!isBlock(current.children) || current.first != NONE) {
+            return false;
+        }
+        const float subWidth = current.bounds.width / 2.f;
+        const float subHeight = current.bounds.height / 2.f;
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            const int child = current.children + quadrant;
+            const sf::FloatRect& bounds = nodes[child].bounds;
+            if (seenNodes[child] || nodes[child].parent != node ||
+                bounds.left != current.bounds.left + (quadrant % 2) * subWidth ||
+                bounds.top != current.bounds.top + (quadrant / 2) * subHeight || bounds.width != subWidth ||
+                bounds.height != subHeight) {
+                return false;
+            }
+            seenNodes[child] = 1;
+            order.push_back(child);
+        }
+    }
+
+    // Comptes et étendues des nœuds internes, les enfants avant leur parent
+    for (size_t i = order.size(); i-- > 0;) {
+        const Node& current = nodes[order[i]];
+        if (current.children == NONE) {
+            continue;
+        }
+        Extent extent;
+        int count = 0, live = 0;
+        for (int child = current.children; child < current.children + 4; ++child) {
+            extent.add(nodes[child].extent);
+            count += nodes[child].count;
+            live += nodes[child].live;
+        }
+        if (count != current.count || live != current.live || !(extent == current.extent)) {
+            return false;
+        }
+    }
+
+    // Le reste est dans les listes libres
+    for (int block = freeChildren; block != NONE; block = nodes[block].children) {
+        if (!isBlock(block)) {
+            return false;
+        }
+        for (int child = block; child < block + 4; ++child) {
+            if (seenNodes[child]) {
+                return false;
+            }
+            seenNodes[child] = 1;
+        }
+    }
+    for (int slot = freeSlots; slot != NONE; slot = slots[slot].next) {
+        if (slot < 0 || slot >= slotCount || seenSlots[slot] || slots[slot].leaf != NONE) {
+            return false;
+        }
+        seenSlots[slot] = 1;
+    }
+    return std::find(seenNodes.begin(), seenNodes.end(), 0) == seenNodes.end() &&
+           std::find(seenSlots.begin(), seenSlots.end(), 0) == seenSlots.end();
+}
+
+int Quadtree::getIndex(const Node& node, const sf::Vector2f& position) const {
+    float verticalMidpoint = node.bounds.left + node.bounds.width / 2.f;
+    float horizontalMidpoint = node.bounds.top + node.bounds.height / 2.f;
+
+    // Un point sur une médiane va à droite ou en bas : tous les points sont
+    // dans les feuilles
+    int index = (position.x < verticalMidpoint) ? 0 : 1;
+    if (position.y >= horizontalMidpoint) {
+        index += 2;
+    }
+    return index;
+}
+
+Quadtree::Extent::Extent()
+    : left(std::numeric_limits<float>::infinity()), top(std::numeric_limits<float>::infinity()),
+      right(-std::numeric_limits<float>::infinity()), bottom(-std::numeric_limits<float>::infinity()) {}
+
+void Quadtree::Extent::add(const sf::Vector2f& position) {
+    left = std::min(left, position.x);
+    top = std::min(top, position.y);
+    right = std::max(right, position.x);
+    bottom = std::max(bottom, position.y);
+}
+
+void Quadtree::Extent::add(const Extent& other) {
+    left = std::min(left, other.left);
+    top = std::min(top, other.top);
+    right = std::max(right, other.right);
+    bottom = std::max(bottom, other.bottom);
+}
+
+bool Quadtree::Extent::operator==(const Extent& other) const {
+    return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+}
+
+float Quadtree::Extent::squaredDistance(const sf::Vector2f& position) const {
+    float dx = std::max(std::max(left - position.x, position.x - right), 0.f);
+    float dy = std::max(std::max(top - position.y, position.y - bottom), 0.f);
+    return dx * dx + dy * dy;
+}
+
+bool Quadtree::Extent::contains(const sf::Vector2f& position) const {
+    return position.x >= left && position.x <= right && position.y >= top && position.y <= bottom;
+}
+
+void Quadtree::split(int node) {
+    int children = freeChildren;
+    if (children != NONE) {
+        freeChildren = nodes[children].children;
+    } else {
+        children = static_cast<int>(nodes.size());
+        nodes.resize(nodes.size() + 4);
+    }
+
+    const sf::FloatRect bounds = nodes[node].bounds;
+    float subWidth = bounds.width / 2.f;
+    float subHeight = bounds.height / 2.f;
+    float x = bounds.left;
+    float y = bounds.top;
+
+    nodes[children + 0] = Node{sf::FloatRect(x, y, subWidth, subHeight), Extent(), NONE, NONE, node, 0, 0};
+    nodes[children + 1] = Node{sf::FloatRect(x + subWidth, y, subWidth, subHeight), Extent(), NONE, NONE, node, 0, 0};
+    nodes[children + 2] = Node{sf::FloatRect(x, y + subHeight, subWidth, subHeight), Extent(), NONE, NONE, node, 0, 0};
+    nodes[children + 3] = Node{sf::FloatRect(x + subWidth, y + subHeight, subWidth, subHeight), Extent(), NONE, NONE, node, 0, 0};
+
+    // Les points de la feuille sont rechaînés dans les enfants, sans copie
+    for (int slot = nodes[node].first; slot != NONE;) {
+        int next = slots[slot].next;
+        const Point& point = slots[slot].point;
+        const int child = children + getIndex(nodes[node], point.position);
+        slots[slot].next = nodes[child].first;
+        slots[slot].leaf = child;
+        nodes[child].first = slot;
+        nodes[child].extent.add(point.position);
+        nodes[child].count++;
+        nodes[child].live += point.hasHealthPack;
+        slot = next;
+    }
+
+    nodes[node].children = children;
+    nodes[node].first = NONE;
+}
+
+void Quadtree::merge(int node) {
+    // Le sous-arbre n'a plus que MAX_POINTS points au plus : ses enfants sont
+    // tous des feuilles, leurs points remontent. L'étendue ne change pas
+    const int children = nodes[node].children;
+    for (int i = 0; i < 4; ++i) {
+        for (int slot = nodes[children + i].first; slot != NONE;) {
+            int next = slots[slot].next;
+            slots[slot].next = nodes[node].first;
+            slots[slot].leaf = node;
+            nodes[node].first = slot;
+            slot = next;
+        }
+    }
+
+    nodes[children].children = freeChildren;
+    freeChildren = children;
+    nodes[node].children = NONE;
+}
+
+// Recalcule l'étendue du nœud puis de ses ancêtres, jusqu'au premier qui ne
+// change pas. Un point qui bouge est rarement à l'extrémité de plus d'un ou
+// deux niveaux : O(1) amorti
+void Quadtree::refit(int node) {
+    for (; node != NONE; node = nodes[node].parent) {
+        Extent extent;
+        const int children = nodes[node].children;
+        if (children == NONE) {
+            for (int slot = nodes[node].first; slot != NONE; slot = slots[slot].next) {
+                extent.add(slots[slot].point.position);
+            }
+        } else {
+            for (int i = 0; i < 4; ++i) {
+                extent.add(nodes[children + i].extent);
+            }
+        }
+        if (extent == nodes[node].extent) {
+            return;
+        }
+        nodes[node].extent = extent;
+    }
+}
+
+int Quadtree::insert(const Point& point) {
+    int slot = freeSlots;
+    if (slot != NONE) {
+        freeSlots = slots[slot].next;
+        slots[slot].point = point;
+    } else {
+        slot = static_cast<int>(slots.size());
+        slots.push_back(Slot{point, NONE, NONE});
+    }
+    attach(slot);
+    return slot;
+}
+
+// Descend de la racine par la boîte qui contient le point
+void Quadtree::attach(int slot) {
+    const sf::Vector2f position = slots[slot].point.position;
+    const int live = slots[slot].point.hasHealthPack;
+    int node = 0;
+    for (int level = 0;; ++level) {
+        if (nodes[node].children == NONE) {
+            if (nodes[node].count < MAX_POINTS || level == MAX_LEVELS) {
+                break;
+            }
+            split(node);
+        }
+        nodes[node].extent.add(position);
+        nodes[node].count++;
+        nodes[node].live += live;
+        node = nodes[node].children + getIndex(nodes[node], position);
+    }
+
+    slots[slot].next = nodes[node].first;
+    slots[slot].leaf = node;
+    nodes[node].first = slot;
+    nodes[node].extent.add(position);
+    nodes[node].count++;
+    nodes[node].live += live;
+}
+
+// Décroche le point de sa feuille ; les comptes sont mis à jour de la feuille
+// à la racine, en fusionnant au passage, puis les étendues
+void Quadtree::detach(int slot) {
+    const int leaf = slots[slot].leaf;
+    int* link = &nodes[leaf].first;
+    while (*link != slot) {
+        link = &slots[*link].next;
+    }
+    *link = slots[slot].next;
+
+    const int live = slots[slot].point.hasHealthPack;
+    int highest = leaf; // la feuille, ou le plus haut nœud fusionné
+    for (int node = leaf; node != NONE; node = nodes[node].parent) {
+        nodes[node].count--;
+        nodes[node].live -= live;
+        if (nodes[node].children != NONE && nodes[node].count <= MAX_POINTS) {
+            merge(node);
+            highest = node;
+        }
+    }
+    refit(highest);
+}
+
+int Quadtree::find(int node, const sf::Vector2f& position, int except) const {
+    const int children = nodes[node].children;
+    if (children == NONE) {
+        for (int slot = nodes[node].first; slot != NONE; slot = slots[slot].next) {
+            const Point& point = slots[slot].point;
+            if (point.position == position && point.hasHealthPack != except) {
+                return slot;
+            }
+        }
+        return NONE;
+    }
+
+    // Les étendues des enfants peuvent se chevaucher
+    for (int i = 0; i < 4; ++i) {
+        if (nodes[children + i].extent.contains(position)) {
+            const int slot = find(children + i, position, except);
+            if (slot != NONE) {
+                return slot;
+            }
+        }
+    }
+    return NONE;
+}
+
+bool Quadtree::remove(const sf::Vector2f& position) {
+    const int slot = find(0, position, NONE);
+    if (slot == NONE) {
+        return false;
+    }
+    remove(slot);
+    return true;
+}
+
+void Quadtree::remove(int id) {
+    detach(id);
+    slots[id].next = freeSlots;
+    slots[id].leaf = NONE;
+    freeSlots = id;
+}
+
+void Quadtree::move(int id, const sf::Vector2f& position) {
+    const int leaf = slots[id].leaf;
+    slots[id].point.position = position;
+    if (looselyContains(nodes[leaf].bounds, position)) {
+        refit(leaf);
+        return;
+    }
+    detach(id);
+    attach(id);
+}
+
+bool Quadtree::setAvailable(const sf::Vector2f& position, bool available) {
+    const int slot = find(0, position, available);
+    if (slot == NONE) {
+        return false;
+    }
+
+    slots[slot].point.hasHealthPack = available;
+    for (int node = slots[slot].leaf; node != NONE; node = nodes[node].parent) {
+        nodes[node].live += available ? 1 : -1;
+    }
+    return true;
+}
+
+void Quadtree::packs(std::vector<sf::Vector2f>& result) const {
+    result.clear();
+    for (const Slot& slot : slots) {
+        if (slot.leaf != NONE && slot.point.hasHealthPack) {
+            result.push_back(slot.point.position);
+        }
+    }
+}
+
+bool Quadtree::nearest(const sf::Vector2f& position, Point& result) const {
+    size_t found = 0;
+    search(0, position, 1, &result, found);
+    return found > 0;
+}
+
+Point Quadtree::nearestFrom(const Point& hint, const sf::Vector2f& position) const {
+    Point result = hint;
+    size_t found = 1;
+    search(0, position, 1, &result, found);
+    return result;
+}
+
+void Quadtree::kNearest(const sf::Vector2f& position, size_t k, std::vector<Point>& result) const {
+    result.resize(k);
+    size_t found = 0;
+    if (k > 0) {
+        search(0, position, k, result.data(), found);
+    }
+    result.resize(found);
+}
+
+// best[0, found) trié par distance croissante. Les distances sont recalculées
+// depuis les positions plutôt que rangées à côté : aucun tampon à allouer
+void Quadtree::search(int node, const sf::Vector2f& position, size_t k, Point* best, size_t& found) const {
+    const int children = nodes[node].children;
+    if (children == NONE) {
+        float worst = (found == k) ? squaredDistance(best[k - 1].position, position)
+                                   : std::numeric_limits<float>::infinity();
+        for (int slot = nodes[node].first; slot != NONE; slot = slots[slot].next) {
+            const Point& point = slots[slot].point;
+            if (!point.hasHealthPack) {
+                continue;
+            }
+            float distance = squaredDistance(point.position, position);
+            if (distance >= worst) {
+                continue;
+            }
+            size_t i = (found < k) ? found++ : k - 1;
+            for (; i > 0 && squaredDistance(best[i - 1].position, position) > distance; --i) {
+                best[i] = best[i - 1];
+            }
+            best[i] = point;
+            if (found == k) {
+                worst = squaredDistance(best[k - 1].position, position);
+            }
+        }
+        return;
+    }
+
+    // Enfants du plus proche au plus lointain
+    int order[4] = {0, 1, 2, 3};
+    float boxDistances[4];
+    for (int i = 0; i < 4; ++i) {
+        boxDistances[i] = nodes[children + i].extent.squaredDistance(position);
+    }
+    for (int i = 1; i < 4; ++i) {
+        for (int j = i; j > 0 && boxDistances[order[j]] < boxDistances[order[j - 1]]; --j) {
+            std::swap(order[j], order[j - 1]);
+        }
+    }
+
+    for (int i : order) {
+        if (found == k && boxDistances[i] >= squaredDistance(best[k - 1].position, position)) {
+            break;
+        }
+        if (nodes[children + i].live > 0) {
+            search(children + i, position, k, best, found);
+        }
+    }
+}
+
+void Quadtree::withinRadius(const sf::Vector2f& position, float radius, std::vector<Point>& result) const {
+    withinRadius(0, position, radius * radius, result);
+}
+
+void Quadtree::withinRadius(int node, const sf::Vector2f& position, float squaredRadius, std::vector<Point>& result) const {
+    const int children = nodes[node].children;
+    if (children == NONE) {
+        for (int slot = nodes[node].first; slot != NONE; slot = slots[slot].next) {
+            const Point& point = slots[slot].point;
+            if (point.hasHealthPack && squaredDistance(point.position, position) <= squaredRadius) {
+                result.push_back(point);
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        if (nodes[children + i].live > 0 && nodes[children + i].extent.squaredDistance(position) <= squaredRadius) {
+            withinRadius(children + i, position, squaredRadius, result);
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef QUADTREE_HPP
+#define QUADTREE_HPP
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <memory>
+#include <vector>
+#include "snapshot.hpp"
+#include "spatial_index.hpp"
+
+// Quadtree à plat : tous les nœuds dans un seul tableau, reliés par indices,
+// les quatre enfants d'un nœud côte à côte, et les points dans un second
+// tableau chaîné par feuille. Les blocs d'enfants et les points libérés
+// passent par des listes libres et sont réutilisés : une fois les tableaux à
+// leur taille, insert et remove n'allouent plus rien. Un nœud dont le
+// sous-arbre retombe à MAX_POINTS points redevient une feuille. Chaque nœud
+// compte aussi les packs disponibles de son sous-arbre : les recherches
+// sautent les sous-arbres sans pack, et un pack ramassé puis réapparu ne
+// change rien à la structure.
+// L'arbre est lâche : un point déplacé reste dans sa feuille tant qu'il ne
+// sort pas de ses bornes lâches, sa boîte élargie de la moitié de sa taille
+// de chaque côté. Les recherches élaguent sur l'étendue de chaque nœud, la
+// boîte englobante de ses points, recalculée en remontant seulement tant
+// qu'elle change. Déplacer tous les points d'un peu à chaque image coûte
+// O(n), sans reconstruction.
+class Quadtree : public SpatialIndex {
+public:
+    explicit Quadtree(sf::FloatRect bounds);
+    void clear();
+    // Identifiant du point, stable jusqu'à son retrait
+    int insert(const Point& point);
+    // Retire un point à exactement cette position, false s'il n'y en a pas. O(profondeur)
+    bool remove(const sf::Vector2f& position);
+    void remove(int id);
+    // O(1) tant que le point reste dans les bornes lâches de sa feuille,
+    // O(profondeur) quand il en sort
+    void move(int id, const sf::Vector2f& position);
+    const Point& point(int id) const { return slots[id].point; }
+    // true si `id` désigne un point de l'arbre, pas un identifiant libéré
+    bool contains(int id) const { return id >= 0 && id < static_cast<int>(slots.size()) && slots[id].leaf != NONE; }
+    // Ramasse (false) ou fait réapparaître (true) un pack à exactement cette
+    // position, sans toucher à la structure. false si aucun point à cette
+    // position n'a changé. O(profondeur)
+    bool setAvailable(const sf::Vector2f& position, bool available);
+    size_t size() const { return nodes[0].count; }
+    size_t available() const override { return nodes[0].live; }
+    // Positions des packs disponibles, par identifiant. O(n)
+    void packs(std::vector<sf::Vector2f>& result) const;
+    const sf::FloatRect& bounds() const { return nodes[0].bounds; }
+    // Nœuds et points champ par champ, listes libres comprises : les
+    // identifiants sont conservés. load() lit les sections en place, copiées
+    // seulement à la première modification de l'arbre ; il rend false, sans
+    // toucher à l'arbre, si une section manque ou si les tailles ne
+    // correspondent pas, O(1), ou avec Snapshot::FULL si l'arbre lu n'est pas
+    // cohérent, O(n)
+    void save(SnapshotWriter& writer) const;
+    bool load(const std::shared_ptr<const Snapshot>& snapshot);
+
+    // Recherches par séparation et évaluation sur les seuls points avec un pack
+    // de soin : les nœuds sont visités du plus proche au plus lointain et
+    // abandonnés dès que leur étendue est plus loin que le meilleur trouvé.
+    // Plus proche pack, false si l'arbre n'en contient aucun
+    bool nearest(const sf::Vector2f& position, Point& result) const override;
+    // Idem en partant d'un pack de l'arbre déjà proche, `hint`, dont la
+    // distance sert de borne initiale : utile pour des requêtes voisines
+    Point nearestFrom(const Point& hint, const sf::Vector2f& position) const;
+    // Les k plus proches packs, du plus proche au plus lointain
+    void kNearest(const sf::Vector2f& position, size_t k, std::vector<Point>& result) const override;
+    // Les packs à une distance <= radius, dans un ordre quelconque
+    void withinRadius(const sf::Vector2f& position, float radius, std::vector<Point>& result) const override;
+
+private:
+    static const int NONE = -1;
+
+    // Boîte englobante des points d'un sous-arbre, vide par défaut
+    struct Extent {
+        Extent();
+        void add(const sf::Vector2f& position);
+        void add(const Extent& other);
+        bool operator==(const Extent& other) const;
+        float squaredDistance(const sf::Vector2f& position) const; // 0 à l'intérieur
+        bool contains(const sf::Vector2f& position) const;
+
+        float left, top, right, bottom;
+    };
+
+    // Lus tels quels dans le snapshot : ni remplissage ni pointeur
+    struct Node {
+        sf::FloatRect bounds; // boîte de découpage
+        Extent extent;
+        int children; // premier des 4 enfants, NONE pour une feuille ; suivant de la liste libre sinon
+        int first;    // premier point d'une feuille
+        int parent;   // NONE pour la racine
+        int count;    // points du sous-arbre
+        int live;     // packs disponibles du sous-arbre
+    };
+
+    struct Slot {
+        Point point;
+        int next; // point suivant de la feuille, ou de la liste libre
+        int leaf; // NONE dans la liste libre
+    };
+
+    int getIndex(const Node& node, const sf::Vector2f& position) const;
+    // Un point à exactement `position` dont le pack n'est pas dans l'état
+    // `except` (NONE : n'importe lequel), ou NONE
+    int find(int node, const sf::Vector2f& position, int except) const;
+    void attach(int slot);
+    void detach(int slot);
+    void split(int node);
+    void merge(int node);
+    void refit(int node);
+    void search(int node, const sf::Vector2f& position, size_t k, Point* best, size_t& found) const;
+    void withinRadius(int node, const sf::Vector2f& position, float squaredRadius, std::vector<Point>& result) const;
+    // Chaque indice dans les bornes, chaque nœud et chaque point atteint une
+    // seule fois depuis la racine ou une liste libre, comptes et étendues exacts
+    static bool consistent(const MappedArray<Node>& nodes, const MappedArray<Slot>& slots, int freeChildren,
+                           int freeSlots);
+
+    static const int MAX_POINTS = 4;
+    static const int MAX_LEVELS = 12;
+
+    MappedArray<Node> nodes; // nodes[0] : la racine
+    MappedArray<Slot> slots;
+    int freeChildren; // liste libre des blocs de 4 nœuds
+    int freeSlots;
+};
+
+#endif // QUADTREE_HPP
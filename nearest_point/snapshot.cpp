@@ -0,0 +1,167 @@
+#include "snapshot.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[8] = "VORSNAP";
+const uint32_t ENDIAN = 0x01020304;
+
+size_t align(size_t offset) {
+    return (offset + Snapshot::ALIGNMENT - 1) / Snapshot::ALIGNMENT * Snapshot::ALIGNMENT;
+}
+
+// FNV-1a par mots de 64 bits, repliée sur 32 : détecte un fichier tronqué ou
+// abîmé, pas une modification volontaire. Environ un mot par multiplication
+uint32_t checksum(const char* bytes, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ull;
+    }
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+}
+
+Snapshot::Snapshot() : data(nullptr), size(0), level(QUICK) {}
+
+Snapshot::~Snapshot() {
+    close();
+}
+
+bool Snapshot::open(const std::string& path, Check check) {
+    close();
+    level = check;
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+        std::cerr << path << " is not a snapshot" << std::endl;
+        ::close(file);
+        return false;
+    }
+    void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Cannot map " << path << std::endl;
+        return false;
+    }
+    data = static_cast<const char*>(mapping);
+    size = status.st_size;
+
+    // Le contenu des sections est vérifié ici avec FULL seulement, sa
+    // cohérence par ceux qui les lisent
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << path << " is not a snapshot" << std::endl;
+    } else if (header->endian != ENDIAN) {
+        std::cerr << path << " was written with another byte order" << std::endl;
+    } else if (header->version != VERSION) {
+        std::cerr << path << " has version " << header->version << ", expected " << VERSION << std::endl;
+    } else if (sizeof(Header) + static_cast<size_t>(header->sections) * sizeof(Entry) > size) {
+        std::cerr << path << " is truncated" << std::endl;
+    } else if (checksum(data + sizeof(Header), header->sections * sizeof(Entry)) != header->checksum) {
+        std::cerr << path << " is corrupted" << std::endl;
+    } else {
+        const Entry* entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+        bool valid = true;
+        for (uint32_t i = 0; i < header->sections; ++i) {
+            valid = valid && entries[i].offset % ALIGNMENT == 0 && entries[i].offset <= size &&
+                    entries[i].size <= size - entries[i].offset;
+        }
+        bool intact = true;
+        for (uint32_t i = 0; valid && check == FULL && i < header->sections; ++i) {
+            intact = intact && checksum(data + entries[i].offset, entries[i].size) == entries[i].checksum;
+        }
+        if (valid && intact) {
+            return true;
+        }
+        std::cerr << path << (valid ? " is corrupted" : " is truncated") << std::endl;
+    }
+    close();
+    return false;
+}
+
+void Snapshot::close() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+bool Snapshot::find(Section tag, const void*& section, size_t& length) const {
+    if (data == nullptr) {
+        return false;
+    }
+    const Header* header = reinterpret_cast<const Header*>(data);
+    const Entry* entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+    for (uint32_t i = 0; i < header->sections; ++i) {
+        if (entries[i].tag == tag) {
+            section = data + entries[i].offset;
+            length = entries[i].size;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SnapshotWriter::write(const std::string& path) const {
+    // Le format est petit-boutiste et lu tel quel
+    const uint32_t endian = ENDIAN;
+    if (*reinterpret_cast<const unsigned char*>(&endian) != 0x04) {
+        std::cerr << "Snapshots can only be written on little-endian machines" << std::endl;
+        return false;
+    }
+
+    Snapshot::Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = Snapshot::VERSION;
+    header.endian = ENDIAN;
+    header.sections = static_cast<uint32_t>(sections.size());
+
+    std::vector<Snapshot::Entry> entries;
+    size_t offset = align(sizeof(header) + sections.size() * sizeof(Snapshot::Entry));
+    for (const auto& section : sections) {
+        const uint32_t sum = checksum(static_cast<const char*>(section.data), section.size);
+        entries.push_back(Snapshot::Entry{section.tag, sum, offset, section.size});
+        offset = align(offset + section.size);
+    }
+    header.checksum = checksum(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Snapshot::Entry));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Snapshot::Entry));
+    const char padding[Snapshot::ALIGNMENT] = {};
+    size_t written = sizeof(header) + entries.size() * sizeof(Snapshot::Entry);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        file.write(padding, entries[i].offset - written);
+        file.write(static_cast<const char*>(sections[i].data), sections[i].size);
+        written = entries[i].offset + sections[i].size;
+    }
+    file.write(padding, align(written) - written);
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
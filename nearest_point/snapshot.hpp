@@ -0,0 +1,259 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Carte binaire lue par mmap, sans analyse : chaque section est un tableau
+// brut, dans la représentation en mémoire de ceux qui la lisent, utilisé en
+// place à son adresse dans le fichier (voir MappedArray).
+//
+// Format, petit-boutiste, version VERSION :
+//   en-tête    char magic[8] = "VORSNAP", uint32 version, uint32 endian
+//              (0x01020304), uint32 sections, uint32 somme de contrôle de
+//              la table
+//   table      par section : uint32 tag, uint32 somme de contrôle de la
+//              section, uint64 offset, uint64 taille en octets
+//   sections   chacune alignée sur ALIGNMENT octets depuis le début
+//
+// Les sites, leurs couleurs et leurs packs sont obligatoires, les index
+// construits (quadtree, graphe de Delaunay) facultatifs : sans eux, ou si
+// leurs tailles ne correspondent pas, le chargement les reconstruit. Par
+// défaut (QUICK) seuls l'en-tête, la table et les tailles sont vérifiés,
+// O(sections) : le contenu est celui qu'a écrit save(). FULL vérifie en plus
+// la somme de contrôle de chaque section et la cohérence des index (indice
+// hors bornes, chaînage cassé, sites qui ne correspondent pas), O(n), pour
+// un fichier dont on ne sait pas d'où il vient. Les sections ne contiennent
+// que des champs de 32 bits, sans remplissage hors des octets qui suivent un
+// booléen, écrits à zéro.
+class Snapshot {
+public:
+    static const uint32_t VERSION = 3;
+    static const size_t ALIGNMENT = 64;
+
+    enum Check { QUICK, FULL };
+
+    enum Section : uint32_t {
+        SITES = 1,   // sf::Vector2f par site
+        SITE_COLORS, // sf::Vector3f par site : rouge, vert, bleu dans [0, 1]
+        PACKS,       // uint8 par site, 1 si le pack est disponible
+        QUADTREE,    // int32 freeChildren, freeSlots : têtes des listes libres
+        // Par nœud, 13 mots : float left, top, width, height (boîte de
+        // découpage) ; float left, top, right, bottom (étendue) ; int32
+        // children, first, parent, count, live. nodes[0] est la racine
+        QUADTREE_NODES,
+        // Par point, 5 mots : float x, y ; uint8 1 si le pack est disponible
+        // et 3 octets à zéro ; int32 next, leaf. Son indice est son identifiant
+        QUADTREE_SLOTS,
+        QUADTREE_IDS, // int32 par site, son identifiant dans le quadtree
+        DELAUNAY,     // float left, top, width, height ; int32 side
+        DELAUNAY_SITES,      // float x, y par site du locator
+        DELAUNAY_OFFSETS,    // int32, sites + 1 : voisins de i dans [offsets[i], offsets[i + 1])
+        DELAUNAY_NEIGHBOURS, // int32, indice de site
+        DELAUNAY_GRID        // int32 par case, side x side : site de départ
+    };
+
+    Snapshot();
+    ~Snapshot();
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    // Projette le fichier en mémoire et vérifie l'en-tête et la table,
+    // O(sections), et avec FULL les sommes de contrôle des sections, O(taille).
+    // false avec un message sur std::cerr sinon
+    bool open(const std::string& path, Check check = QUICK);
+    void close();
+    // Le niveau de vérification demandé à open(), que suivent ceux qui lisent
+    // les sections
+    Check check() const { return level; }
+
+    // Tableau de la section, nullptr si elle manque ou si sa taille n'est pas
+    // un multiple de sizeof(T). Valide jusqu'à close()
+    template <typename T>
+    const T* get(Section tag, size_t& count) const {
+        const void* data;
+        size_t size;
+        if (!find(tag, data, size) || size % sizeof(T) != 0) {
+            return nullptr;
+        }
+        count = size / sizeof(T);
+        return static_cast<const T*>(data);
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint32_t sections;
+        uint32_t checksum; // de la table
+    };
+
+    struct Entry {
+        uint32_t tag;
+        uint32_t checksum; // de la section
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    friend class SnapshotWriter;
+
+    bool find(Section tag, const void*& data, size_t& size) const;
+
+    const char* data;
+    size_t size;
+    Check level;
+};
+
+// Tableau lu en place dans un Snapshot, qu'il garde projeté, tant qu'il n'est
+// pas modifié : le premier accès en écriture (opérateur [] ou begin() non
+// constants, push_back, resize...) le copie dans un vecteur, O(n) une seule
+// fois. L'interface constante et at() lisent sans jamais copier, at() même
+// sur un tableau non constant. assign() et clear() remplacent le contenu sans
+// le copier.
+template <typename T>
+class MappedArray {
+public:
+    MappedArray() : items(nullptr), count(0) {}
+    MappedArray(const MappedArray& other) : source(other.source), owned(other.owned) { sync(other); }
+    MappedArray(MappedArray&& other) : source(std::move(other.source)), owned(std::move(other.owned)) {
+        sync(other);
+        other.clear();
+    }
+    MappedArray& operator=(MappedArray other) {
+        source.swap(other.source);
+        owned.swap(other.owned);
+        sync(other);
+        return *this;
+    }
+
+    // Lit la section en place, false si elle manque ou si sa taille n'est pas
+    // un multiple de sizeof(T) ; le tableau ne change pas alors
+    bool map(const std::shared_ptr<const Snapshot>& snapshot, Snapshot::Section tag) {
+        size_t length = 0;
+        const T* section = snapshot->get<T>(tag, length);
+        if (section == nullptr) {
+            return false;
+        }
+        std::vector<T>().swap(owned);
+        source = snapshot;
+        items = section;
+        count = length;
+        return true;
+    }
+    bool mapped() const { return source != nullptr; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* data() const { return items; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+    const T& operator[](size_t i) const { return items[i]; }
+    const T& at(size_t i) const { return items[i]; }
+    const T& back() const { return items[count - 1]; }
+
+    T* begin() { return own().data(); }
+    T* end() { return own().data() + count; }
+    T& operator[](size_t i) { return own()[i]; }
+    T& back() { return own().back(); }
+    void push_back(const T& value) {
+        own().push_back(value);
+        sync();
+    }
+    void resize(size_t n) {
+        own().resize(n);
+        sync();
+    }
+    void erase(const T* position) {
+        own().erase(owned.begin() + (position - owned.data()));
+        sync();
+    }
+
+    void assign(size_t n, const T& value) {
+        owned.assign(n, value);
+        source.reset();
+        sync();
+    }
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        owned.assign(first, last); // avant reset : [first, last) peut être dans la vue
+        source.reset();
+        sync();
+    }
+    void clear() {
+        owned.clear();
+        source.reset();
+        sync();
+    }
+
+private:
+    // Le vecteur, copié de la vue au premier appel
+    std::vector<T>& own() {
+        if (mapped()) {
+            owned.assign(items, items + count);
+            source.reset();
+            sync();
+        }
+        return owned;
+    }
+    void sync() {
+        items = owned.data();
+        count = owned.size();
+    }
+    void sync(const MappedArray& other) {
+        if (mapped()) {
+            items = other.items;
+            count = other.count;
+        } else {
+            sync();
+        }
+    }
+
+    std::shared_ptr<const Snapshot> source; // nullptr une fois copié
+    const T* items; // la vue, ou owned.data()
+    size_t count;
+    std::vector<T> owned;
+};
+
+// Assemble les sections puis écrit le fichier d'un coup
+class SnapshotWriter {
+public:
+    // Le tableau n'est pas copié : il doit vivre jusqu'à write()
+    template <typename T>
+    void add(Snapshot::Section tag, const T* data, size_t count) {
+        sections.push_back(Pending{tag, data, count * sizeof(T)});
+    }
+    // Copié, pour les petits en-têtes
+    template <typename T>
+    void addValue(Snapshot::Section tag, const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        copies.push_back(std::vector<char>(bytes, bytes + sizeof(T)));
+        sections.push_back(Pending{tag, copies.back().data(), sizeof(T)});
+    }
+    // Copié, pour les tableaux construits le temps de l'écriture
+    template <typename T>
+    void addCopy(Snapshot::Section tag, const std::vector<T>& values) {
+        const char* bytes = reinterpret_cast<const char*>(values.data());
+        copies.push_back(std::vector<char>(bytes, bytes + values.size() * sizeof(T)));
+        sections.push_back(Pending{tag, copies.back().data(), values.size() * sizeof(T)});
+    }
+
+    // false avec un message sur std::cerr si l'écriture échoue
+    bool write(const std::string& path) const;
+
+private:
+    struct Pending {
+        Snapshot::Section tag;
+        const void* data;
+        size_t size;
+    };
+
+    std::vector<Pending> sections;
+    std::vector<std::vector<char>> copies;
+};
+
+#endif // SNAPSHOT_HPP
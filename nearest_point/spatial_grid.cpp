@@ -0,0 +1,305 @@
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPATIAL_GRID_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const float INFINITE = std::numeric_limits<float>::infinity();
+
+void nearestScalar(const float* xs, const float* ys, uint32_t begin, uint32_t end, float px, float py,
+                   float& best, uint32_t& index) {
+    for (uint32_t i = begin; i < end; ++i) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        float distance = dx * dx + dy * dy;
+        if (distance < best) {
+            best = distance;
+            index = i;
+        }
+    }
+}
+
+void withinScalar(const float* xs, const float* ys, const Point* packs, uint32_t begin, uint32_t end, float px,
+                  float py, float squaredRadius, std::vector<Point>& result) {
+    for (uint32_t i = begin; i < end; ++i) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        if (dx * dx + dy * dy <= squaredRadius) {
+            result.push_back(packs[i]);
+        }
+    }
+}
+
+#ifdef SPATIAL_GRID_AVX2
+// Compilées pour AVX2 sans -mavx2 : appelées seulement si le processeur le
+// supporte, le reste du programme tourne partout
+__attribute__((target("avx2"))) void nearestAvx2(const float* xs, const float* ys, uint32_t begin, uint32_t end,
+                                                 float px, float py, float& best, uint32_t& index) {
+    uint32_t i = begin;
+    if (end - begin >= 8) {
+        const __m256 qx = _mm256_set1_ps(px);
+        const __m256 qy = _mm256_set1_ps(py);
+        const __m256i step = _mm256_set1_epi32(8);
+        __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256 distances = _mm256_set1_ps(best);
+        __m256i indices = _mm256_set1_epi32(-1);
+        for (; i + 8 <= end; i += 8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), qx);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), qy);
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            __m256 closer = _mm256_cmp_ps(distance, distances, _CMP_LT_OQ);
+            distances = _mm256_blendv_ps(distances, distance, closer);
+            indices = _mm256_blendv_epi8(indices, lanes, _mm256_castps_si256(closer));
+            lanes = _mm256_add_epi32(lanes, step);
+        }
+
+        // Le meilleur des 8 couloirs
+        float laneDistances[8];
+        int laneIndices[8];
+        _mm256_storeu_ps(laneDistances, distances);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(laneIndices), indices);
+        for (int lane = 0; lane < 8; ++lane) {
+            if (laneDistances[lane] < best) {
+                best = laneDistances[lane];
+                index = static_cast<uint32_t>(laneIndices[lane]);
+            }
+        }
+    }
+    nearestScalar(xs, ys, i, end, px, py, best, index);
+}
+
+__attribute__((target("avx2"))) void withinAvx2(const float* xs, const float* ys, const Point* packs, uint32_t begin,
+                                                uint32_t end, float px, float py, float squaredRadius,
+                                                std::vector<Point>& result) {
+    uint32_t i = begin;
+    const __m256 qx = _mm256_set1_ps(px);
+    const __m256 qy = _mm256_set1_ps(py);
+    const __m256 radius = _mm256_set1_ps(squaredRadius);
+    for (; i + 8 <= end; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), qx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), qy);
+        __m256 distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        for (int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance, radius, _CMP_LE_OQ)); mask != 0; mask &= mask - 1) {
+            result.push_back(packs[i + __builtin_ctz(mask)]);
+        }
+    }
+    withinScalar(xs, ys, packs, i, end, px, py, squaredRadius, result);
+}
+#endif
+
+bool supportsAvx2() {
+#ifdef SPATIAL_GRID_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+}
+
+SpatialGrid::SpatialGrid(bool simd)
+    : box(0, 0, 1, 1), columns(1), rows(1), scaleX(1), scaleY(1), slack(0), avx2(simd && supportsAvx2()),
+      offsets(2, 0) {}
+
+int SpatialGrid::column(float x) const {
+    int c = static_cast<int>((x - box.left) * scaleX);
+    return std::min(std::max(c, 0), columns - 1);
+}
+
+int SpatialGrid::row(float y) const {
+    int r = static_cast<int>((y - box.top) * scaleY);
+    return std::min(std::max(r, 0), rows - 1);
+}
+
+void SpatialGrid::build(const std::vector<Point>& points) {
+    float left = INFINITE, top = INFINITE, right = -INFINITE, bottom = -INFINITE;
+    uint32_t count = 0;
+    for (const auto& point : points) {
+        if (point.hasHealthPack) {
+            left = std::min(left, point.position.x);
+            top = std::min(top, point.position.y);
+            right = std::max(right, point.position.x);
+            bottom = std::max(bottom, point.position.y);
+            count++;
+        }
+    }
+    if (count == 0) {
+        left = top = right = bottom = 0;
+    }
+
+    // Une boîte d'au moins 1 de côté, des cases à peu près carrées
+    box = sf::FloatRect(left, top, std::max(right - left, 1.f), std::max(bottom - top, 1.f));
+    const int wanted = std::max<int>(1, count / POINTS_PER_CELL);
+    columns = std::min(wanted, std::max(1, static_cast<int>(std::sqrt(wanted * box.width / box.height))));
+    rows = std::max(1, wanted / columns);
+    scaleX = columns / box.width;
+    scaleY = rows / box.height;
+    slack = 1e-5f * (std::abs(box.left) + std::abs(box.top) + box.width + box.height);
+
+    // Tri par dénombrement des packs par case
+    cells.resize(count);
+    offsets.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    uint32_t i = 0;
+    for (const auto& point : points) {
+        if (point.hasHealthPack) {
+            cells[i] = row(point.position.y) * columns + column(point.position.x);
+            offsets[cells[i] + 1]++;
+            i++;
+        }
+    }
+    for (size_t c = 1; c < offsets.size(); ++c) {
+        offsets[c] += offsets[c - 1];
+    }
+    xs.resize(count);
+    ys.resize(count);
+    packs.resize(count);
+    i = 0;
+    for (const auto& point : points) {
+        if (point.hasHealthPack) {
+            const uint32_t slot = offsets[cells[i++]]++;
+            xs[slot] = point.position.x;
+            ys[slot] = point.position.y;
+            packs[slot] = point;
+        }
+    }
+    // Chaque tête d'écriture a avancé jusqu'au début de la case suivante
+    for (size_t c = offsets.size() - 2; c > 0; --c) {
+        offsets[c] = offsets[c - 1];
+    }
+    offsets[0] = 0;
+}
+
+float SpatialGrid::outside(const sf::Vector2f& position, int x0, int x1, int y0, int y1) const {
+    float distance = INFINITE;
+    if (x0 > 0) {
+        distance = std::min(distance, position.x - (box.left + x0 / scaleX));
+    }
+    if (x1 < columns - 1) {
+        distance = std::min(distance, box.left + (x1 + 1) / scaleX - position.x);
+    }
+    if (y0 > 0) {
+        distance = std::min(distance, position.y - (box.top + y0 / scaleY));
+    }
+    if (y1 < rows - 1) {
+        distance = std::min(distance, box.top + (y1 + 1) / scaleY - position.y);
+    }
+    return std::max(distance - slack, 0.f);
+}
+
+void SpatialGrid::scan(uint32_t begin, uint32_t end, const sf::Vector2f& position, float& best, uint32_t& index) const {
+#ifdef SPATIAL_GRID_AVX2
+    if (avx2) {
+        nearestAvx2(xs.data(), ys.data(), begin, end, position.x, position.y, best, index);
+        return;
+    }
+#endif
+    nearestScalar(xs.data(), ys.data(), begin, end, position.x, position.y, best, index);
+}
+
+// Parcourt les anneaux de cases autour de `position` : les deux lignes d'un
+// anneau sont chacune un seul intervalle de packs. S'arrête quand l'anneau
+// suivant est au moins à `bound()`, une distance au carré
+template <typename Scan, typename Bound>
+void SpatialGrid::rings(const sf::Vector2f& position, Scan scan, Bound bound) const {
+    const int cx = column(position.x);
+    const int cy = row(position.y);
+    for (int r = 0;; ++r) {
+        const int x0 = cx - r, x1 = cx + r, y0 = cy - r, y1 = cy + r;
+        const int left = std::max(x0, 0), right = std::min(x1, columns - 1);
+        const int top = std::max(y0, 0), bottom = std::min(y1, rows - 1);
+        for (int y = top; y <= bottom; ++y) {
+            const uint32_t* line = &offsets[static_cast<size_t>(y) * columns];
+            if (y == y0 || y == y1) {
+                scan(line[left], line[right + 1]);
+            } else {
+                if (x0 >= 0) {
+                    scan(line[x0], line[x0 + 1]);
+                }
+                if (x1 < columns) {
+                    scan(line[x1], line[x1 + 1]);
+                }
+            }
+        }
+
+        if (x0 <= 0 && x1 >= columns - 1 && y0 <= 0 && y1 >= rows - 1) {
+            return;
+        }
+        const float distance = outside(position, x0, x1, y0, y1);
+        if (distance * distance >= bound()) {
+            return;
+        }
+    }
+}
+
+bool SpatialGrid::nearest(const sf::Vector2f& position, Point& result) const {
+    if (packs.empty()) {
+        return false;
+    }
+    float best = INFINITE;
+    uint32_t index = 0;
+    rings(position, [&](uint32_t begin, uint32_t end) { scan(begin, end, position, best, index); },
+          [&]() { return best; });
+    result = packs[index];
+    return true;
+}
+
+void SpatialGrid::kNearest(const sf::Vector2f& position, size_t k, std::vector<Point>& result) const {
+    result.clear();
+    if (k == 0 || packs.empty()) {
+        return;
+    }
+    // Les k meilleurs triés par distance croissante, comme dans le quadtree
+    std::vector<float> distances;
+    result.reserve(k);
+    distances.reserve(k);
+    rings(position,
+          [&](uint32_t begin, uint32_t end) {
+              for (uint32_t i = begin; i < end; ++i) {
+                  float dx = xs[i] - position.x;
+                  float dy = ys[i] - position.y;
+                  float distance = dx * dx + dy * dy;
+                  if (result.size() == k && distance >= distances.back()) {
+                      continue;
+                  }
+                  if (result.size() < k) {
+                      result.push_back(packs[i]);
+                      distances.push_back(distance);
+                  }
+                  size_t j = result.size() - 1;
+                  for (; j > 0 && distances[j - 1] > distance; --j) {
+                      result[j] = result[j - 1];
+                      distances[j] = distances[j - 1];
+                  }
+                  result[j] = packs[i];
+                  distances[j] = distance;
+              }
+          },
+          [&]() { return (result.size() == k) ? distances.back() : INFINITE; });
+}
+
+void SpatialGrid::withinRadius(const sf::Vector2f& position, float radius, std::vector<Point>& result) const {
+    if (packs.empty()) {
+        return;
+    }
+    const float squaredRadius = radius * radius;
+    const int left = column(position.x - radius - slack), right = column(position.x + radius + slack);
+    const int top = row(position.y - radius - slack), bottom = row(position.y + radius + slack);
+    for (int y = top; y <= bottom; ++y) {
+        const uint32_t* line = &offsets[static_cast<size_t>(y) * columns];
+#ifdef SPATIAL_GRID_AVX2
+        if (avx2) {
+            withinAvx2(xs.data(), ys.data(), packs.data(), line[left], line[right + 1], position.x, position.y,
+                       squaredRadius, result);
+            continue;
+        }
+#endif
+        withinScalar(xs.data(), ys.data(), packs.data(), line[left], line[right + 1], position.x, position.y,
+                     squaredRadius, result);
+    }
+}
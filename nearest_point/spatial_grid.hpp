@@ -0,0 +1,61 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <vector>
+#include "spatial_index.hpp"
+
+// Grille uniforme de packs, pour des packs répartis à peu près uniformément.
+// Les positions sont rangées case par case dans deux tableaux séparés, x et
+// y : une ligne de cases est un intervalle contigu de ces tableaux, parcouru
+// 8 points à la fois en AVX2 quand le processeur le permet. Le plus proche
+// est cherché par anneaux de cases autour de la requête, jusqu'à ce que
+// l'anneau suivant soit plus loin que le meilleur trouvé. Statique : à
+// reconstruire quand un pack change, en O(n).
+class SpatialGrid : public SpatialIndex {
+public:
+    // simd à false : noyau scalaire même si le processeur a AVX2, pour comparer
+    explicit SpatialGrid(bool simd = true);
+
+    // Range les packs par case, les points sans pack sont ignorés. La grille
+    // couvre leur boîte englobante, environ POINTS_PER_CELL packs par case.
+    // Les tampons sont gardés d'un appel à l'autre
+    void build(const std::vector<Point>& points);
+
+    bool nearest(const sf::Vector2f& position, Point& result) const override;
+    void kNearest(const sf::Vector2f& position, size_t k, std::vector<Point>& result) const override;
+    void withinRadius(const sf::Vector2f& position, float radius, std::vector<Point>& result) const override;
+    size_t available() const override { return packs.size(); }
+
+private:
+    static const int POINTS_PER_CELL = 2;
+
+    int column(float x) const;
+    int row(float y) const;
+    // Distance de `position` au plus proche côté du bloc de cases
+    // [x0, x1] x [y0, y1] derrière lequel il reste des cases, une borne
+    // inférieure pour tous les packs hors du bloc. Infinie si le bloc couvre
+    // toute la grille
+    float outside(const sf::Vector2f& position, int x0, int x1, int y0, int y1) const;
+    template <typename Scan, typename Bound>
+    void rings(const sf::Vector2f& position, Scan scan, Bound bound) const;
+    // Le plus proche des packs [begin, end), s'il est à moins de `best`
+    void scan(uint32_t begin, uint32_t end, const sf::Vector2f& position, float& best, uint32_t& index) const;
+
+    sf::FloatRect box;
+    int columns, rows;
+    float scaleX, scaleY; // cases par unité
+    float slack;          // marge des bornes contre les arrondis
+    bool avx2;
+
+    // Packs de la case c : [offsets[c], offsets[c + 1]), cases ligne par ligne
+    std::vector<uint32_t> offsets;
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<Point> packs;
+    std::vector<uint32_t> cells; // tampon de build
+};
+
+#endif // SPATIAL_GRID_HPP
@@ -0,0 +1,97 @@
+#include "spatial_index.hpp"
+#include "spatial_grid.hpp"
+#include "quadtree.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const int POINTS_PER_BIN = 8;
+// Au-delà, le quadtree répond plus vite que la grille
+const float MAX_GRID_SCAN_COST = 12.f;
+
+}
+
+float gridScanCost(const std::vector<Point>& points) {
+    float left = std::numeric_limits<float>::infinity(), top = left, right = -left, bottom = -left;
+    int count = 0;
+    for (const auto& point : points) {
+        if (point.hasHealthPack) {
+            left = std::min(left, point.position.x);
+            top = std::min(top, point.position.y);
+            right = std::max(right, point.position.x);
+            bottom = std::max(bottom, point.position.y);
+            count++;
+        }
+    }
+    if (count == 0) {
+        return 1.f;
+    }
+
+    // Mêmes proportions que les cases de SpatialGrid, en plus gros
+    const float width = std::max(right - left, 1.f);
+    const float height = std::max(bottom - top, 1.f);
+    const int wanted = std::max(1, count / POINTS_PER_BIN);
+    const int columns = std::min(wanted, std::max(1, static_cast<int>(std::sqrt(wanted * width / height))));
+    const int rows = std::max(1, wanted / columns);
+
+    // Distance de Tchebychev à la plus proche case occupée, en deux passes
+    const int unreached = columns + rows;
+    std::vector<int> distances(columns * rows, unreached);
+    for (const auto& point : points) {
+        if (point.hasHealthPack) {
+            int x = std::min(columns - 1, static_cast<int>((point.position.x - left) * columns / width));
+            int y = std::min(rows - 1, static_cast<int>((point.position.y - top) * rows / height));
+            distances[y * columns + x] = 0;
+        }
+    }
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            int& d = distances[y * columns + x];
+            for (int dx = -1; dx <= 1 && y > 0; ++dx) {
+                if (x + dx >= 0 && x + dx < columns) {
+                    d = std::min(d, distances[(y - 1) * columns + x + dx] + 1);
+                }
+            }
+            if (x > 0) {
+                d = std::min(d, distances[y * columns + x - 1] + 1);
+            }
+        }
+    }
+    double cost = 0.0;
+    for (int y = rows - 1; y >= 0; --y) {
+        for (int x = columns - 1; x >= 0; --x) {
+            int& d = distances[y * columns + x];
+            for (int dx = -1; dx <= 1 && y < rows - 1; ++dx) {
+                if (x + dx >= 0 && x + dx < columns) {
+                    d = std::min(d, distances[(y + 1) * columns + x + dx] + 1);
+                }
+            }
+            if (x < columns - 1) {
+                d = std::min(d, distances[y * columns + x + 1] + 1);
+            }
+            cost += static_cast<double>(2 * d + 1) * (2 * d + 1);
+        }
+    }
+    return static_cast<float>(cost / distances.size());
+}
+
+std::unique_ptr<SpatialIndex> makeSpatialIndex(const std::vector<Point>& points, const sf::FloatRect& bounds) {
+    if (gridScanCost(points) <= MAX_GRID_SCAN_COST) {
+        std::unique_ptr<SpatialGrid> grid(new SpatialGrid());
+        grid->build(points);
+        return grid;
+    }
+    std::unique_ptr<Quadtree> quadtree(new Quadtree(bounds));
+    for (const auto& point : points) {
+        quadtree->insert(point);
+    }
+    return quadtree;
+}
+
+Point nearestHealthPack(const SpatialIndex& index, const sf::Vector2f& position) {
+    Point nearestPack = {position, false};
+    index.nearest(position, nearestPack);
+    return nearestPack;
+}
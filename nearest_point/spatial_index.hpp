@@ -0,0 +1,42 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <memory>
+#include <vector>
+
+struct Point {
+    sf::Vector2f position;
+    bool hasHealthPack;
+};
+
+// Recherches communes au quadtree et à la grille, sur les seuls points avec
+// un pack de soin
+class SpatialIndex {
+public:
+    virtual ~SpatialIndex() {}
+
+    // Plus proche pack, false si l'index n'en contient aucun
+    virtual bool nearest(const sf::Vector2f& position, Point& result) const = 0;
+    // Les k plus proches packs, du plus proche au plus lointain
+    virtual void kNearest(const sf::Vector2f& position, size_t k, std::vector<Point>& result) const = 0;
+    // Les packs à une distance <= radius, dans un ordre quelconque
+    virtual void withinRadius(const sf::Vector2f& position, float radius, std::vector<Point>& result) const = 0;
+    virtual size_t available() const = 0;
+};
+
+// Cases qu'une requête de la grille parcourt en moyenne : sur une grille
+// grossière des packs, (2d + 1)² par case, d la distance en cases à la plus
+// proche case occupée. Autour de 1 pour des packs uniformes, des centaines
+// quand des amas serrés laissent de grands vides
+float gridScanCost(const std::vector<Point>& points);
+
+// Grille si gridScanCost est assez bas, quadtree sinon. Seuil mesuré avec
+// des amas plus ou moins serrés, comme le cas « clustered » de `bench`
+std::unique_ptr<SpatialIndex> makeSpatialIndex(const std::vector<Point>& points, const sf::FloatRect& bounds);
+
+// Plus proche point avec un pack de soin, ou un point sans pack s'il n'y en a aucun
+Point nearestHealthPack(const SpatialIndex& index, const sf::Vector2f& position);
+
+#endif // SPATIAL_INDEX_HPP
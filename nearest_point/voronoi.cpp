@@ -1,94 +1,22 @@
 #include "voronoi.hpp"
+#include "snapshot.hpp"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 
-// Implémentation de la classe Quadtree
-Quadtree::Quadtree(int level, sf::FloatRect bounds)
-    : level(level), bounds(bounds) {}
-
-void Quadtree::clear() {
-    points.clear();
-    for (auto& node : nodes) {
-        if (node) {
-            node->clear();
-            node.reset();
-        }
-    }
-}
-
-void Quadtree::split() {
-    float subWidth = bounds.width / 2.f;
-    float subHeight = bounds.height / 2.f;
-    float x = bounds.left;
-    float y = bounds.top;
-
-    nodes[0] = std::make_unique<Quadtree>(level + 1, sf::FloatRect(x, y, subWidth, subHeight));
-    nodes[1] = std::make_unique<Quadtree>(level + 1, sf::FloatRect(x + subWidth, y, subWidth, subHeight));
-    nodes[2] = std::make_unique<Quadtree>(level + 1, sf::FloatRect(x, y + subHeight, subWidth, subHeight));
-    nodes[3] = std::make_unique<Quadtree>(level + 1, sf::FloatRect(x + subWidth, y + subHeight, subWidth, subHeight));
-}
-
-int Quadtree::getIndex(const sf::Vector2f& position) const {
-    int index = -1;
-    float verticalMidpoint = bounds.left + bounds.width / 2.f;
-    float horizontalMidpoint = bounds.top + bounds.height / 2.f;
-
-    bool topQuadrant = (position.y < horizontalMidpoint);
-    bool bottomQuadrant = (position.y > horizontalMidpoint);
-
-    if (position.x < verticalMidpoint) {
-        if (topQuadrant) {
-            index = 0;
-        } else if (bottomQuadrant) {
-            index = 2;
-        }
-    } else {
-        if (topQuadrant) {
-            index = 1;
-        } else if (bottomQuadrant) {
-            index = 3;
-        }
-    }
-
-    return index;
-}
-
-void Quadtree::insert(const Point& point) {
-    if (!nodes[0]) {
-        if (points.size() < MAX_POINTS || level == MAX_LEVELS) {
-            points.push_back(point);
-            return;
-        }
-
-        split();
-    }
-
-    int index = getIndex(point.position);
-    if (index != -1) {
-        nodes[index]->insert(point);
-    } else {
-        points.push_back(point);
-    }
-}
-
-void Quadtree::retrieve(std::vector<Point>& returnPoints, const sf::Vector2f& position) {
-    int index = getIndex(position);
-    if (index != -1 && nodes[0]) {
-        nodes[index]->retrieve(returnPoints, position);
-    }
-
-    returnPoints.insert(returnPoints.end(), points.begin(), points.end());
-}
-
 // Implémentation de la classe Voronoi
-Voronoi::Voronoi(int width, int height, int initialPoints)
+Voronoi::Voronoi(int width, int height, int worldScale, int initialPoints)
     : WIDTH(width), HEIGHT(height), pointsNumber(initialPoints),
-      quadtree(0, sf::FloatRect(0, 0, width, height)),
       window(sf::VideoMode(width, height), "Voronoi Diagram", sf::Style::Close | sf::Style::Titlebar, sf::ContextSettings(0, 0, 8)),
-      gen(dev()), wRand(30.0, width - 30.0), hRand(30.0, height - 30.0) {
+      camera(sf::FloatRect(0, 0, width, height)), panning(false), dragged(-1),
+      world(sf::FloatRect(0, 0, width * worldScale, height * worldScale), World::TILE_PIXELS),
+      quadtree(sf::FloatRect(0, 0, width * worldScale, height * worldScale)),
+      finder(quadtree), mouseHint(DelaunayLocator::NONE), gen(dev()), wRand(30.0, width * worldScale - 30.0), hRand(30.0, height * worldScale - 30.0),
+      site(4, 100), mapPath("map.snap") {
 
+    window.setFramerateLimit(60);
     window.setPosition(sf::Vector2i(0, 0));
+    window.setView(camera);
     coordinates.resize(pointsNumber);
     std::generate(coordinates.begin(), coordinates.end(), [&]() { return sf::Vector2f(wRand(gen), hRand(gen)); });
 
@@ -98,15 +26,10 @@ Voronoi::Voronoi(int width, int height, int initialPoints)
     std::generate(colors.begin(), colors.end(), [&]() { return sf::Vector3f(frand(gen), frand(gen), frand(gen)); });
 #endif
 
-    sf::CircleShape tempPoint(4, 100);
-    tempPoint.setFillColor(sf::Color::Black);
-    tempPoint.setOrigin(4, 4);
-    tempPoint.setOutlineColor(sf::Color::Green);
+    site.setOutlineColor(sf::Color::Green);
 
     for (auto& coord : coordinates) {
-        tempPoint.setPosition(coord);
-        circles.push_back({tempPoint, false});
-        quadtree.insert({coord, true});
+        ids.push_back(quadtree.insert({coord, true}));
     }
 
 
@@ -136,6 +59,89 @@ bool Voronoi::initialize() {
     return true;
 }
 
+bool Voronoi::load(const std::string& path, Snapshot::Check check) {
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    if (!snapshot->open(path, check)) {
+        return false;
+    }
+    // Tout est lu en place, copié seulement au premier site modifié
+    MappedArray<sf::Vector2f> sites;
+    MappedArray<sf::Vector3f> siteColors;
+    MappedArray<uint8_t> packs;
+    if (!sites.map(snapshot, Snapshot::SITES) || !siteColors.map(snapshot, Snapshot::SITE_COLORS) ||
+        !packs.map(snapshot, Snapshot::PACKS) || siteColors.size() != sites.size() || packs.size() != sites.size()) {
+        std::cerr << path << " has no sites, colors or packs" << std::endl;
+        return false;
+    }
+    const size_t count = sites.size();
+
+    // Le quadtree enregistré garde les identifiants de chaque site. Il n'est
+    // repris que s'il couvre le même monde avec un point par site ; avec
+    // Snapshot::FULL, chaque site doit en plus y avoir son propre point, à sa
+    // position et avec son pack. Sinon il est reconstruit
+    const sf::FloatRect bounds = quadtree.bounds();
+    MappedArray<int> loadedIds;
+    bool loaded = loadedIds.map(snapshot, Snapshot::QUADTREE_IDS) && loadedIds.size() == count &&
+                  quadtree.load(snapshot) && quadtree.bounds() == bounds && quadtree.size() == count;
+    if (loaded && check == Snapshot::FULL) {
+        for (size_t i = 0; loaded && i < count; ++i) {
+            const int id = loadedIds.at(i);
+            loaded = quadtree.contains(id) && quadtree.point(id).position == sites.at(i) &&
+                     quadtree.point(id).hasHealthPack == (packs.at(i) != 0);
+        }
+        if (loaded) {
+            std::vector<int> distinct(loadedIds.data(), loadedIds.data() + count);
+            std::sort(distinct.begin(), distinct.end());
+            loaded = std::adjacent_find(distinct.begin(), distinct.end()) == distinct.end();
+        }
+    }
+    if (loaded) {
+        ids = std::move(loadedIds);
+    } else {
+        quadtree = Quadtree(bounds);
+        ids.clear();
+        for (size_t i = 0; i < count; ++i) {
+            ids.push_back(quadtree.insert({sites.at(i), packs.at(i) != 0}));
+        }
+    }
+    coordinates = std::move(sites);
+#ifdef COLORS
+    colors = std::move(siteColors);
+#endif
+    pointsNumber = static_cast<int>(count);
+
+    // Les tuiles de la carte précédente ne servent plus
+    world.reset(quadtree.bounds());
+    clampCamera();
+    finder.load(snapshot);
+    mouseHint = DelaunayLocator::NONE;
+    dragged = -1;
+    mapPath = path;
+    return true;
+}
+
+bool Voronoi::save(const std::string& path) const {
+#ifdef COLORS
+    const sf::Vector3f* siteColors = colors.data();
+#else
+    const std::vector<sf::Vector3f> white(coordinates.size(), sf::Vector3f(1.f, 1.f, 1.f));
+    const sf::Vector3f* siteColors = white.data();
+#endif
+    std::vector<uint8_t> packs(coordinates.size());
+    for (size_t i = 0; i < coordinates.size(); ++i) {
+        packs[i] = quadtree.point(ids[i]).hasHealthPack;
+    }
+
+    SnapshotWriter writer;
+    writer.add(Snapshot::SITES, coordinates.data(), coordinates.size());
+    writer.add(Snapshot::SITE_COLORS, siteColors, coordinates.size());
+    writer.add(Snapshot::PACKS, packs.data(), packs.size());
+    quadtree.save(writer);
+    writer.add(Snapshot::QUADTREE_IDS, ids.data(), ids.size());
+    finder.save(writer);
+    return writer.write(path);
+}
+
 void Voronoi::run() {
     while (window.isOpen()) {
         handleEvents();
@@ -146,59 +152,80 @@ void Voronoi::run() {
 
 void Voronoi::addPoint(sf::Vector2f position) {
     coordinates.push_back(position);
-    sf::CircleShape tempPoint(4, 100);
-    tempPoint.setFillColor(sf::Color::Black);
-    tempPoint.setOrigin(4, 4);
-    tempPoint.setOutlineColor(sf::Color::Green);
-    tempPoint.setPosition(position);
-    circles.push_back({tempPoint, false});
-    quadtree.insert({position, true});
+    ids.push_back(quadtree.insert({position, true}));
+    world.changed(position);
 
 #ifdef COLORS
     colors.push_back(sf::Vector3f(frand(gen), frand(gen), frand(gen)));
 #endif
 
     pointsNumber++;
+    finder.changed();
 }
 
-void Voronoi::removePoint(sf::Vector2f position) {
-    auto it = std::find_if(coordinates.begin(), coordinates.end(), [&](const sf::Vector2f& point) {
-        return sqrt(pow(point.x - position.x, 2) + pow(point.y - position.y, 2)) < 5.0f; // tolérance de 5 pixels
+int Voronoi::siteAt(const sf::Vector2f& position) {
+    // Tolérance de 5 pixels de l'écran, cherchée parmi les sites autour
+    const float tolerance = 5.0f * zoom();
+    std::vector<int> nearby;
+    world.sitesIn(coordinates.data(), coordinates.size(),
+                  sf::FloatRect(position.x - tolerance, position.y - tolerance, 2 * tolerance, 2 * tolerance), nearby);
+    auto it = std::find_if(nearby.begin(), nearby.end(), [&](int i) {
+        return std::hypot(coordinates.at(i).x - position.x, coordinates.at(i).y - position.y) < tolerance;
     });
+    return (it != nearby.end()) ? *it : -1;
+}
+
+void Voronoi::moveSite(int index, sf::Vector2f position) {
+    // Le site reste dans le monde, et donc dans la racine du quadtree
+    const sf::FloatRect& bounds = world.bounds();
+    position.x = std::min(std::max(position.x, bounds.left), bounds.left + bounds.width);
+    position.y = std::min(std::max(position.y, bounds.top), bounds.top + bounds.height);
+
+    world.changed(coordinates.at(index));
+    coordinates[index] = position;
+    quadtree.move(ids.at(index), position);
+    world.changed(position);
+    // O(1) : la triangulation est seulement périmée, et seulement si le site
+    // porte un pack
+    if (quadtree.point(ids.at(index)).hasHealthPack) {
+        finder.changed();
+    }
+}
+
+void Voronoi::togglePack(sf::Vector2f position) {
+    const int index = siteAt(position);
+    if (index == -1) {
+        return;
+    }
+    // Sur place, sans toucher à la structure du quadtree
+    const bool available = !quadtree.point(ids.at(index)).hasHealthPack;
+    if (quadtree.setAvailable(coordinates.at(index), available)) {
+        finder.changed();
+    }
+}
 
-    if (it != coordinates.end()) {
-        int index = std::distance(coordinates.begin(), it);
-        coordinates.erase(it);
-        circles.erase(circles.begin() + index);
+void Voronoi::removePoint(sf::Vector2f position) {
+    const int index = siteAt(position);
+    if (index != -1) {
+        dragged = -1; // les indices suivants se décalent
+        world.changed(coordinates.at(index));
+        if (quadtree.point(ids.at(index)).hasHealthPack) {
+            finder.changed();
+        }
+        quadtree.remove(ids.at(index));
+        ids.erase(ids.begin() + index);
+        coordinates.erase(coordinates.begin() + index);
 #ifdef COLORS
         colors.erase(colors.begin() + index);
 #endif
         pointsNumber--;
-        quadtree.clear();
-        for (const auto& coord : coordinates) {
-            quadtree.insert({coord, true});
-        }
     }
 }
 
 Point Voronoi::findNearestHealthPack(const sf::Vector2f& position) {
-    std::vector<Point> possiblePoints;
-    quadtree.retrieve(possiblePoints, position);
-
-    Point nearestPack;
-    float minDistance = std::numeric_limits<float>::infinity();
-
-    for (const auto& point : possiblePoints) {
-        if (point.hasHealthPack) {
-            float distance = sqrt(pow(point.position.x - position.x, 2) + pow(point.position.y - position.y, 2));
-            if (distance < minDistance) {
-                minDistance = distance;
-                nearestPack = point;
-            }
-        }
-    }
-
-    return nearestPack;
+    // Le curseur bouge peu d'une image à l'autre : la marche part de la
+    // réponse précédente et ne fait que quelques pas
+    return finder.nearest(position, mouseHint);
 }
 
 void Voronoi::visualizeNearestHealthPack(const sf::Vector2f& position) {
@@ -207,6 +234,18 @@ void Voronoi::visualizeNearestHealthPack(const sf::Vector2f& position) {
     std::cout << "Nearest health pack at: (" << nearestPack.position.x << ", " << nearestPack.position.y << ")" << std::endl;
 }
 
+float Voronoi::zoom() const {
+    return camera.getSize().x / WIDTH;
+}
+
+void Voronoi::clampCamera() {
+    const sf::FloatRect& bounds = world.bounds();
+    sf::Vector2f center = camera.getCenter();
+    center.x = std::min(std::max(center.x, bounds.left), bounds.left + bounds.width);
+    center.y = std::min(std::max(center.y, bounds.top), bounds.top + bounds.height);
+    camera.setCenter(center);
+}
+
 void Voronoi::handleEvents() {
     sf::Event event;
     while (window.pollEvent(event)) {
@@ -214,78 +253,124 @@ void Voronoi::handleEvents() {
             window.close();
         }
 
+        // Bouton gauche : tire le site sous le curseur, ou en ajoute un
         if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
-            addPoint(mousePos);
+            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y), camera);
+            dragged = siteAt(mousePos);
+            if (dragged == -1 && world.bounds().contains(mousePos)) {
+                addPoint(mousePos);
+            }
+        }
+        if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
+            dragged = -1;
+        }
+        if (event.type == sf::Event::MouseMoved && dragged != -1) {
+            moveSite(dragged, window.mapPixelToCoords(sf::Vector2i(event.mouseMove.x, event.mouseMove.y), camera));
+        }
+
+        // P : ramasse le pack du site sous le curseur, ou le fait réapparaître
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P) {
+            togglePack(window.mapPixelToCoords(sf::Mouse::getPosition(window), camera));
+        }
+
+        // S : enregistre la carte, index compris
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S && save(mapPath)) {
+            std::cout << "Map saved to " << mapPath << std::endl;
         }
 
         if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
-            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y), camera);
             removePoint(mousePos);
             visualizeNearestHealthPack(mousePos); // Visualiser le point le plus proche après suppression
         }
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LAlt) && event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-            bool outOfCircle = std::none_of(circles.begin(), circles.end(), [&](const auto& circle) {
-                return circle.first.getGlobalBounds().contains(sf::Vector2f(sf::Mouse::getPosition(window)));
-            });
-
-            if (outOfCircle) {
-                coordinates.push_back(sf::Vector2f(sf::Mouse::getPosition(window)));
-                sf::CircleShape tempPoint(4, 100);
-                tempPoint.setFillColor(sf::Color::Black);
-                tempPoint.setOrigin(4, 4);
-                tempPoint.setOutlineColor(sf::Color::Green);
-                tempPoint.setPosition(coordinates.back());
-                circles.push_back({tempPoint, false});
-                quadtree.insert({coordinates.back(), true}); // Insérer le nouveau point dans le quadtree
+        // Bouton du milieu : la caméra suit la souris
+        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Middle) {
+            panning = true;
+            panFrom = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+        }
+        if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Middle) {
+            panning = false;
+        }
+        if (event.type == sf::Event::MouseMoved && panning) {
+            const sf::Vector2i mouse(event.mouseMove.x, event.mouseMove.y);
+            camera.move(sf::Vector2f(panFrom - mouse) * zoom());
+            clampCamera();
+            panFrom = mouse;
+        }
 
-#ifdef COLORS
-                colors.push_back(sf::Vector3f(frand(gen), frand(gen), frand(gen)));
-#endif
+        // Molette : zoom autour du curseur
+        if (event.type == sf::Event::MouseWheelScrolled) {
+            const sf::Vector2i mouse(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+            const sf::Vector2f before = window.mapPixelToCoords(mouse, camera);
+            const float factor = event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f;
+            const float scale = std::min(std::max(zoom() * factor, MIN_ZOOM), MAX_ZOOM);
+            camera.setSize(WIDTH * scale, HEIGHT * scale);
+            camera.move(before - window.mapPixelToCoords(mouse, camera));
+            clampCamera();
+        }
 
-                pointsNumber++;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LAlt) && event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y), camera);
+            const float radius = 4.0f * zoom();
+            std::vector<int> nearby;
+            world.sitesIn(coordinates.data(), coordinates.size(),
+                          sf::FloatRect(mousePos.x - radius, mousePos.y - radius, 2 * radius, 2 * radius), nearby);
+
+            if (nearby.empty() && world.bounds().contains(mousePos)) {
+                addPoint(mousePos);
             }
         }
     }
 }
 
 void Voronoi::update() {
-    for (size_t i = 0; i < pointsNumber; i++) {
-        auto mousePos = sf::Mouse::getPosition(window);
-        float radius = (std::hypot(mousePos.x - coordinates[i].x, mousePos.y - coordinates[i].y) <= 10.0) ? 6.0 : 4.0;
-        circles[i].first.setRadius(radius);
-        circles[i].first.setOrigin(radius, radius);
-
-        if (circles[i].second) {
-            coordinates[i] = sf::Vector2f(sf::Mouse::getPosition(window));
-            circles[i].first.setPosition(coordinates[i]);
-        }
+    // Flèches : la caméra glisse de PAN_SPEED pixels de l'écran par image
+    const sf::Vector2f pan(sf::Keyboard::isKeyPressed(sf::Keyboard::Right) - sf::Keyboard::isKeyPressed(sf::Keyboard::Left),
+                           sf::Keyboard::isKeyPressed(sf::Keyboard::Down) - sf::Keyboard::isKeyPressed(sf::Keyboard::Up));
+    if (pan != sf::Vector2f()) {
+        camera.move(pan * (PAN_SPEED * zoom()));
+        clampCamera();
     }
+
+    // Seuls les sites de la vue sont dessinés, marge comprise pour ceux à cheval sur le bord
+    const float margin = 6.0f * zoom();
+    const sf::Vector2f corner = camera.getCenter() - camera.getSize() / 2.f;
+    world.sitesIn(coordinates.data(), coordinates.size(),
+                  sf::FloatRect(corner.x - margin, corner.y - margin, camera.getSize().x + 2 * margin,
+                                camera.getSize().y + 2 * margin),
+                  visible);
+
+    // Le plus proche pack suit le curseur
+    nearestPackCircle.setPosition(findNearestHealthPack(window.mapPixelToCoords(sf::Mouse::getPosition(window), camera)).position);
 }
 
 void Voronoi::render() {
     window.clear(sf::Color::White);
-
-    std::vector<sf::Vector2f> copy(coordinates.size());
-    std::transform(coordinates.begin(), coordinates.end(), copy.begin(), [&](sf::Vector2f vec) {
-        return sf::Vector2f(vec.x, window.getSize().y - vec.y);
-    });
-
-    shader.setUniform("size", pointsNumber);
-    shader.setUniformArray("seeds", copy.data(), MAX_POINTS_NUMBER);
+    window.setView(camera);
 
 #ifdef COLORS
-    shader.setUniformArray("colors", colors.data(), MAX_POINTS_NUMBER);
+    world.draw(window, shader, coordinates.data(), coordinates.size(), colors.data());
+#else
+    world.draw(window, shader, coordinates.data(), coordinates.size(), nullptr);
 #endif
 
-    window.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
-
-    for (auto& c : circles) {
-        window.draw(c.first);
+    // Les cercles gardent leur taille à l'écran quel que soit le zoom
+    const float scale = zoom();
+    const sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window), camera);
+    for (int i : visible) {
+        const sf::Vector2f& position = coordinates.at(i);
+        float radius = (std::hypot(mousePos.x - position.x, mousePos.y - position.y) <= 10.0 * scale) ? 6.0 : 4.0;
+        site.setRadius(radius * scale);
+        site.setOrigin(radius * scale, radius * scale);
+        site.setPosition(position);
+        site.setFillColor(quadtree.point(ids.at(i)).hasHealthPack ? sf::Color::Black : sf::Color(160, 160, 160));
+        window.draw(site);
     }
 
+    nearestPackCircle.setRadius(6.0f * scale);
+    nearestPackCircle.setOrigin(6.0f * scale, 6.0f * scale);
     window.draw(nearestPackCircle); // Dessiner le cercle du point le plus proche
 
     window.display();
-}
\ No newline at end of file
+}
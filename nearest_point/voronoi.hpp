@@ -4,37 +4,27 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <random>
-#include <memory>
-
-struct Point {
-    sf::Vector2f position;
-    bool hasHealthPack;
-};
-
-class Quadtree {
-public:
-    Quadtree(int level, sf::FloatRect bounds);
-    void clear();
-    void split();
-    int getIndex(const sf::Vector2f& position) const;
-    void insert(const Point& point);
-    void retrieve(std::vector<Point>& returnPoints, const sf::Vector2f& position);
-
-private:
-    static const int MAX_POINTS = 4;
-    static const int MAX_LEVELS = 5;
-
-    int level;
-    sf::FloatRect bounds;
-    std::vector<Point> points;
-    std::unique_ptr<Quadtree> nodes[4];
-};
+#include <string>
+#include "pack_finder.hpp"
+#include "quadtree.hpp"
+#include "snapshot.hpp"
+#include "world.hpp"
 
+// Le monde fait worldScale fois la fenêtre de côté ; la caméra s'y déplace
+// avec les flèches ou le bouton du milieu, et zoome avec la molette. Un site
+// se tire au bouton gauche ; P ramasse son pack ou le fait réapparaître, un
+// site sans pack est dessiné en gris
 class Voronoi {
 public:
-    Voronoi(int width, int height, int initialPoints);
+    Voronoi(int width, int height, int worldScale, int initialPoints);
     bool initialize();
     void run();
+    // Remplace les sites par ceux d'une carte, et reprend le quadtree et la
+    // triangulation s'ils y sont, lus en place. false avec un message si elle
+    // est illisible. Snapshot::FULL pour une carte dont on ne sait pas d'où
+    // elle vient : O(n) au lieu de O(1)
+    bool load(const std::string& path, Snapshot::Check check = Snapshot::QUICK);
+    bool save(const std::string& path) const;
 
 private:
     void handleEvents();
@@ -42,23 +32,48 @@ private:
     void render();
     void addPoint(sf::Vector2f position);
     void removePoint(sf::Vector2f position);
+    // Site à moins de 5 pixels de l'écran de `position`, ou -1
+    int siteAt(const sf::Vector2f& position);
+    // Déplace le site en place dans le quadtree, gardé dans le monde
+    void moveSite(int index, sf::Vector2f position);
+    // Ramasse ou fait réapparaître le pack du site sous `position`
+    void togglePack(sf::Vector2f position);
     Point findNearestHealthPack(const sf::Vector2f& position);
     void visualizeNearestHealthPack(const sf::Vector2f& position);
+    // Unités du monde par pixel de l'écran
+    float zoom() const;
+    // Garde le centre de la caméra dans le monde
+    void clampCamera();
 
     const int WIDTH;
     const int HEIGHT;
     int pointsNumber;
-    const int MAX_POINTS_NUMBER = 512;
+    const float MIN_ZOOM = 0.25f;
+    const float MAX_ZOOM = 8.0f;
+    const float PAN_SPEED = 12.0f; // pixels de l'écran par image
 
     sf::RenderWindow window;
     sf::Shader shader;
-    std::vector<sf::Vector2f> coordinates;
-    std::vector<std::pair<sf::CircleShape, bool>> circles;
+    sf::View camera;
+    bool panning; // bouton du milieu enfoncé
+    sf::Vector2i panFrom;
+    int dragged; // site tiré au bouton gauche, ou -1
+    // Le diagramme est rendu par tuiles, refaites seulement quand un site
+    // proche change ; les sites visibles sont dessinés par-dessus
+    World world;
+    std::vector<int> visible; // sites dans la vue, refaits à chaque image
+    // Lus en place dans la carte chargée tant qu'aucun site ne change ; les
+    // lectures passent par at(), qui ne copie pas
+    MappedArray<sf::Vector2f> coordinates;
+    MappedArray<int> ids; // identifiant de chaque site dans le quadtree
 
     Quadtree quadtree;
+    // Plus proche pack du curseur, depuis celui de l'image précédente
+    PackFinder finder;
+    int mouseHint;
 
 #ifdef COLORS
-    std::vector<sf::Vector3f> colors;
+    MappedArray<sf::Vector3f> colors;
 #endif
 
     std::random_device dev;
@@ -70,7 +85,9 @@ private:
     std::uniform_real_distribution<> frand;
 #endif
 
+    sf::CircleShape site; // dessiné à la position de chaque site visible
     sf::CircleShape nearestPackCircle; // Cercle pour visualiser le point le plus proche
+    std::string mapPath; // carte chargée, écrasée par S
 };
 
 #endif // VORONOI_HPP
@@ -0,0 +1,288 @@
+#include "world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+float squaredDistance(const sf::Vector2f& a, const sf::Vector2f& b) {
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+// 0 à l'intérieur de `rect`
+float squaredDistance(const sf::FloatRect& rect, const sf::Vector2f& position) {
+    float dx = std::max(std::max(rect.left - position.x, position.x - (rect.left + rect.width)), 0.f);
+    float dy = std::max(std::max(rect.top - position.y, position.y - (rect.top + rect.height)), 0.f);
+    return dx * dx + dy * dy;
+}
+
+uint64_t key(int level, int x, int y) {
+    return static_cast<uint64_t>(level - World::MIN_LEVEL) << 48 | static_cast<uint64_t>(y) << 24 |
+           static_cast<uint64_t>(x);
+}
+
+}
+
+World::World(sf::FloatRect bounds, float tileSize)
+    : tileSize(tileSize), sorted(false), frame(0) {
+    reset(bounds);
+}
+
+void World::reset(sf::FloatRect bounds) {
+    area = bounds;
+    columns = std::max(1, static_cast<int>(std::ceil(bounds.width / tileSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(bounds.height / tileSize)));
+    sorted = false;
+    tiles.clear();
+}
+
+int World::column(float x) const {
+    float cell = (x - area.left) / tileSize;
+    return static_cast<int>(std::min(std::max(cell, 0.f), static_cast<float>(columns - 1)));
+}
+
+int World::row(float y) const {
+    float cell = (y - area.top) / tileSize;
+    return static_cast<int>(std::min(std::max(cell, 0.f), static_cast<float>(rows - 1)));
+}
+
+void World::changed(const sf::Vector2f& position) {
+    sorted = false;
+    for (auto& entry : tiles) {
+        Tile& tile = entry.second;
+        if (!tile.dirty && squaredDistance(tile.scope, position) <= tile.reach * tile.reach) {
+            tile.dirty = true;
+        }
+    }
+}
+
+// Les sites hors des bornes vont dans la tuile du bord la plus proche : les
+// recherches restent exactes, elles les filtrent sur leur vraie position
+void World::sort(const sf::Vector2f* sites, size_t count) {
+    if (sorted) {
+        return;
+    }
+    offsets.assign(columns * rows + 1, 0);
+    cells.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        cells[i] = row(sites[i].y) * columns + column(sites[i].x);
+        offsets[cells[i] + 1]++;
+    }
+    for (size_t t = 1; t < offsets.size(); ++t) {
+        offsets[t] += offsets[t - 1];
+    }
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[offsets[cells[i]]++] = static_cast<uint32_t>(i);
+    }
+    for (size_t t = offsets.size() - 1; t > 0; --t) {
+        offsets[t] = offsets[t - 1];
+    }
+    offsets[0] = 0;
+    sorted = true;
+}
+
+void World::sitesIn(const sf::Vector2f* sites, size_t count, const sf::FloatRect& region, std::vector<int>& result) {
+    sort(sites, count);
+    result.clear();
+    const int x1 = column(region.left + region.width), y1 = row(region.top + region.height);
+    for (int y = row(region.top); y <= y1; ++y) {
+        for (int x = column(region.left); x <= x1; ++x) {
+            const int t = y * columns + x;
+            for (uint32_t i = offsets[t]; i < offsets[t + 1]; ++i) {
+                if (squaredDistance(region, sites[order[i]]) == 0.f) {
+                    result.push_back(order[i]);
+                }
+            }
+        }
+    }
+}
+
+// Soit s le plus proche site du centre c de `region`, h sa demi-diagonale.
+// Tout point p de `region` a un site à moins de |p - s| <= |c - s| + h : un
+// site plus loin que cette portée de toute la région n'y est jamais le plus
+// proche
+float World::affecting(const sf::Vector2f* sites, size_t count, const sf::FloatRect& region,
+                       std::vector<int>& result) {
+    sort(sites, count);
+    result.clear();
+    if (count == 0) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    // Plus proche site du centre, par anneaux de tuiles : après l'anneau r,
+    // les sites restants sont à plus de r tuiles du centre
+    const sf::Vector2f center(region.left + region.width / 2.f, region.top + region.height / 2.f);
+    const int cx = column(center.x), cy = row(center.y);
+    float best = std::numeric_limits<float>::infinity();
+    auto scan = [&](int x, int y) {
+        const int t = y * columns + x;
+        for (uint32_t i = offsets[t]; i < offsets[t + 1]; ++i) {
+            best = std::min(best, squaredDistance(sites[order[i]], center));
+        }
+    };
+    for (int r = 0; r <= std::max(columns, rows); ++r) {
+        const int left = std::max(cx - r, 0), right = std::min(cx + r, columns - 1);
+        for (int y = std::max(cy - r, 0); y <= std::min(cy + r, rows - 1); ++y) {
+            if (y == cy - r || y == cy + r) {
+                for (int x = left; x <= right; ++x) {
+                    scan(x, y);
+                }
+            } else {
+                if (cx - r >= 0) {
+                    scan(cx - r, y);
+                }
+                if (cx + r < columns) {
+                    scan(cx + r, y);
+                }
+            }
+        }
+        if (best <= static_cast<float>(r) * r * tileSize * tileSize) {
+            break;
+        }
+    }
+
+    const float halfDiagonal = std::sqrt(region.width * region.width + region.height * region.height) / 2.f;
+    const float reach = (std::sqrt(best) + halfDiagonal) * 1.0001f;
+    const int x1 = column(region.left + region.width + reach), y1 = row(region.top + region.height + reach);
+    for (int y = row(region.top - reach); y <= y1; ++y) {
+        for (int x = column(region.left - reach); x <= x1; ++x) {
+            const int t = y * columns + x;
+            for (uint32_t i = offsets[t]; i < offsets[t + 1]; ++i) {
+                if (squaredDistance(region, sites[order[i]]) <= reach * reach) {
+                    result.push_back(order[i]);
+                }
+            }
+        }
+    }
+    return reach;
+}
+
+int World::level(float zoom) {
+    const int l = static_cast<int>(std::ceil(std::log2(zoom) - 1e-4f));
+    return l < MIN_LEVEL ? MIN_LEVEL : l > MAX_LEVEL ? MAX_LEVEL : l;
+}
+
+void World::draw(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f* sites, size_t count,
+                 const sf::Vector3f* colors) {
+    frame++;
+    const sf::View& view = target.getView();
+    const int l = level(view.getSize().x / target.getSize().x);
+    const float side = std::ldexp(tileSize, l);
+    const sf::Vector2f corner = view.getCenter() - view.getSize() / 2.f;
+    const int lastColumn = static_cast<int>(std::ceil(area.width / side)) - 1;
+    const int lastRow = static_cast<int>(std::ceil(area.height / side)) - 1;
+    const int x0 = std::max(static_cast<int>(std::floor((corner.x - area.left) / side)), 0);
+    const int y0 = std::max(static_cast<int>(std::floor((corner.y - area.top) / side)), 0);
+    const int x1 = std::min(static_cast<int>(std::floor((corner.x + view.getSize().x - area.left) / side)), lastColumn);
+    const int y1 = std::min(static_cast<int>(std::floor((corner.y + view.getSize().y - area.top) / side)), lastRow);
+
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            auto it = tiles.find(key(l, x, y));
+            if (it == tiles.end()) {
+                // Place faite en oubliant la tuile vue il y a le plus longtemps
+                if (tiles.size() >= MAX_RESIDENT) {
+                    auto oldest = tiles.begin();
+                    for (auto candidate = tiles.begin(); candidate != tiles.end(); ++candidate) {
+                        if (candidate->second.used < oldest->second.used) {
+                            oldest = candidate;
+                        }
+                    }
+                    if (oldest->second.used < frame) {
+                        tiles.erase(oldest);
+                    }
+                }
+                Tile tile;
+                tile.texture.reset(new sf::RenderTexture());
+                if (!tile.texture->create(TILE_PIXELS, TILE_PIXELS)) {
+                    std::cerr << "Failed to create a tile texture!" << std::endl;
+                    return;
+                }
+                tile.region = sf::FloatRect(area.left + x * side, area.top + y * side, side, side);
+                const float edge = EDGE_PIXELS * side / TILE_PIXELS;
+                tile.scope = sf::FloatRect(tile.region.left - edge, tile.region.top - edge, side + 2.f * edge,
+                                           side + 2.f * edge);
+                tile.reach = 0.f;
+                tile.dirty = true;
+                tile.used = frame;
+                it = tiles.emplace(key(l, x, y), std::move(tile)).first;
+            }
+
+            Tile& tile = it->second;
+            tile.used = frame;
+            if (tile.dirty) {
+                render(tile, shader, sites, count, colors);
+            }
+            sf::Sprite sprite(tile.texture->getTexture());
+            sprite.setPosition(tile.region.left, tile.region.top);
+            sprite.setScale(side / TILE_PIXELS, side / TILE_PIXELS);
+            target.draw(sprite);
+        }
+    }
+}
+
+void World::render(Tile& tile, sf::Shader& shader, const sf::Vector2f* sites, size_t count,
+                   const sf::Vector3f* colors) {
+    tile.reach = affecting(sites, count, tile.scope, found);
+    tile.texture->clear(sf::Color::White);
+    render(tile, 0, 0, TILE_PIXELS, shader, sites, count, colors);
+    tile.texture->display();
+    tile.dirty = false;
+}
+
+void World::render(Tile& tile, int x, int y, int size, sf::Shader& shader, const sf::Vector2f* sites, size_t count,
+                   const sf::Vector3f* colors) {
+    const float scale = tile.region.width / TILE_PIXELS; // unités par pixel
+    const sf::FloatRect region(tile.region.left + x * scale, tile.region.top + y * scale, size * scale, size * scale);
+    if (found.size() > static_cast<size_t>(MAX_SITES)) {
+        if (size >= 2 * MIN_PART_PIXELS) {
+            // Chaque quart n'a que les sites qui l'affectent, bien moins nombreux
+            const int half = size / 2;
+            const float edge = EDGE_PIXELS * scale;
+            for (int quadrant = 0; quadrant < 4; ++quadrant) {
+                const int partX = x + (quadrant % 2) * half, partY = y + (quadrant / 2) * half;
+                affecting(sites, count,
+                          sf::FloatRect(tile.region.left + partX * scale - edge, tile.region.top + partY * scale - edge,
+                                        half * scale + 2.f * edge, half * scale + 2.f * edge),
+                          found);
+                render(tile, partX, partY, half, shader, sites, count, colors);
+            }
+            return;
+        }
+        // Les plus proches du centre, faute de mieux : les cellules du bord
+        // de cette partie peuvent être fausses
+        const sf::Vector2f center(region.left + region.width / 2.f, region.top + region.height / 2.f);
+        std::nth_element(found.begin(), found.begin() + MAX_SITES, found.end(), [&](int a, int b) {
+            return squaredDistance(sites[a], center) < squaredDistance(sites[b], center);
+        });
+        std::cerr << found.size() << " sites near (" << center.x << ", " << center.y << "), only the " << MAX_SITES
+                  << " nearest are drawn: zoom in" << std::endl;
+        found.resize(MAX_SITES);
+    }
+
+    // Coordonnées des pixels de la texture, origine en bas à gauche
+    const float pixels = TILE_PIXELS / tile.region.width;
+    seeds.clear();
+    seedColors.clear();
+    for (int i : found) {
+        seeds.push_back(sf::Vector2f((sites[i].x - tile.region.left) * pixels,
+                                     TILE_PIXELS - (sites[i].y - tile.region.top) * pixels));
+        if (colors != nullptr) {
+            seedColors.push_back(colors[i]);
+        }
+    }
+
+    shader.setUniform("size", static_cast<int>(seeds.size()));
+    shader.setUniformArray("seeds", seeds.data(), seeds.size());
+    if (colors != nullptr) {
+        shader.setUniformArray("colors", seedColors.data(), seedColors.size());
+    }
+
+    sf::RectangleShape part(sf::Vector2f(size, size));
+    part.setPosition(x, y);
+    tile.texture->draw(part, &shader);
+}
@@ -0,0 +1,101 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Monde plus grand que la fenêtre. Les sites sont rangés par tuile carrée de
+// tileSize unités, et le diagramme est rendu tuile par tuile dans des
+// textures de TILE_PIXELS pixels : une tuile est rendue à la première image
+// où elle est visible, puis gardée tant qu'elle sert, au plus MAX_RESIDENT.
+// Une tuile de niveau l couvre tileSize * 2^l unités : le niveau suit le
+// zoom, pour qu'une vue compte toujours à peu près autant de tuiles.
+// Le shader d'une tuile ne reçoit que les sites qui peuvent colorer l'un de
+// ses pixels : le coût d'une image suit la surface visible, pas la taille
+// du monde. Une tuile où plus de MAX_SITES sites comptent est rendue par
+// quarts, chacun avec ses seuls sites, jusqu'à MIN_PART_PIXELS pixels.
+class World {
+public:
+    static const int MAX_SITES = 512; // taille des tableaux des shaders
+    static const int TILE_PIXELS = 256;
+    static const int MIN_LEVEL = -2;
+    static const int MAX_LEVEL = 3;
+
+    World(sf::FloatRect bounds, float tileSize);
+    // Nouvelles bornes, plus aucune tuile rendue
+    void reset(sf::FloatRect bounds);
+    const sf::FloatRect& bounds() const { return area; }
+
+    // Un site a été ajouté ou retiré à `position` : les sites seront rangés
+    // de nouveau à la prochaine requête, et les tuiles rendues où il colore
+    // ou colorerait un pixel sont à refaire. Un site déplacé : une fois pour
+    // l'ancienne position, une fois pour la nouvelle
+    void changed(const sf::Vector2f& position);
+
+    // Les sites sont passés comme `count` positions à `sites`, un vecteur ou
+    // un tableau lu en place dans un snapshot.
+    // Indices des sites dans `region`, bords compris
+    void sitesIn(const sf::Vector2f* sites, size_t count, const sf::FloatRect& region, std::vector<int>& result);
+    // Indices des sites qui peuvent être le plus proche d'un point de
+    // `region`, un sur-ensemble. Rend la portée : un site à plus de cette
+    // distance de `region` n'y est jamais le plus proche, infinie sans site
+    float affecting(const sf::Vector2f* sites, size_t count, const sf::FloatRect& region, std::vector<int>& result);
+
+    // Niveau des tuiles pour `zoom` unités par pixel de l'écran : chaque
+    // pixel d'une tuile couvre au plus un pixel de l'écran
+    static int level(float zoom);
+    // Dessine le diagramme dans la vue de `target`, en rendant d'abord les
+    // tuiles visibles qui manquent. `colors` : une par site, nullptr pour le
+    // shader sans couleurs
+    void draw(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f* sites, size_t count,
+              const sf::Vector3f* colors);
+    size_t residentTiles() const { return tiles.size(); }
+
+private:
+    static const size_t MAX_RESIDENT = 128;
+    static const int EDGE_PIXELS = 3; // épaisseur des arêtes de voronoi.frag
+    // Plus petite partie d'une tuile rendue à part : au-delà de MAX_SITES
+    // sites, seuls les plus proches de son centre sont dessinés
+    static const int MIN_PART_PIXELS = 8;
+
+    struct Tile {
+        std::unique_ptr<sf::RenderTexture> texture;
+        sf::FloatRect region; // couverte par la texture
+        sf::FloatRect scope;  // region élargie des arêtes, ce que le shader regarde
+        float reach;          // portée des sites de scope
+        bool dirty;
+        uint64_t used; // dernière image où la tuile était visible
+    };
+
+    int column(float x) const;
+    int row(float y) const;
+    // Range les sites par tuile si besoin, tri par dénombrement en O(n)
+    void sort(const sf::Vector2f* sites, size_t count);
+    void render(Tile& tile, sf::Shader& shader, const sf::Vector2f* sites, size_t count, const sf::Vector3f* colors);
+    // Carré de `size` pixels en (x, y) dans la texture, `found` tenant les
+    // sites qui l'affectent
+    void render(Tile& tile, int x, int y, int size, sf::Shader& shader, const sf::Vector2f* sites, size_t count,
+                const sf::Vector3f* colors);
+
+    sf::FloatRect area;
+    float tileSize;
+    int columns, rows;
+    bool sorted;
+    // Sites de la tuile t : order[offsets[t]..offsets[t + 1]), tuiles ligne par ligne
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> cells; // tampon de sort
+
+    std::unordered_map<uint64_t, Tile> tiles; // rendues, par niveau et position
+    uint64_t frame;
+
+    // Tampons de render
+    std::vector<int> found;
+    std::vector<sf::Vector2f> seeds;
+    std::vector<sf::Vector3f> seedColors;
+};
+
+#endif // WORLD_HPP
@@ -0,0 +1,173 @@
+// Benchmarks of the graph construction, of A* and of the safest paths, one JSON document on stdout to diff between commits.
+// Usage: ./bench [maxSites] [maxThreads]
+#include "voronoi.hpp"
+#include "incremental_voronoi.hpp"
+#include "safest_path.hpp"
+#include "search_context.hpp"
+#include "path_service.hpp"
+#include "thread_pool.hpp"
+#include "benchmark.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1920;
+const int HEIGHT = 1080;
+const unsigned SEED = 12345;
+const int QUERIES = 16; // A* runs per measure
+const int CLICKS = 16;  // sites added per measure of IncrementalVoronoi::insert
+const int BATCH = 512;  // routes asked in one AI tick
+const int BATCH_SOURCES = 16;
+const unsigned THREADS[] = {1, 2, 4, 8, 16, 32, 64}; // up to maxThreads, the hardware threads by default
+const int SIZES[] = {10, 100, 1000, 10000, 100000};
+
+// Swallows the A* trace of an -DASTAR_TRACE build, so that its formatting cost is measured but not its terminal
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+};
+
+}
+
+int main(int argc, char const* argv[]) {
+    const int maxSites = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    const unsigned maxThreads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2])) : std::thread::hardware_concurrency();
+    NullBuffer null;
+
+    beginReport();
+    for (int sites : SIZES) {
+        if (sites > maxSites) {
+            break;
+        }
+        const std::vector<sf::Vector2f> points = randomPoints(sites, SEED + sites, WIDTH, HEIGHT);
+
+        NavGraph navGraph;
+        sf::VertexArray lines(sf::Lines);
+        measure("generateVoronoi", sites, 1, [&]() {
+            buildVoronoiGraph(points, navGraph, lines);
+            sink = sink + navGraph.size();
+        });
+
+        IncrementalVoronoi incremental;
+        measure("IncrementalVoronoi build", sites, sites, [&]() {
+            incremental.clear();
+            for (const auto& point : points) {
+                incremental.insert(point);
+            }
+        });
+
+        // What the app does before a search once sites were added
+        NavGraph compacted;
+        measure("IncrementalVoronoi::compact", sites, 1, [&]() {
+            incremental.compact(compacted);
+            sink = sink + compacted.targets.size();
+        });
+
+        // A click on a map of `sites` sites: each run adds CLICKS sites to
+        // the same graph, so it slowly grows past `sites`
+        const std::vector<sf::Vector2f> clicks = randomPoints(1 << 20, SEED - sites, WIDTH, HEIGHT);
+        size_t click = 0;
+        measure("IncrementalVoronoi::insert", sites, CLICKS, [&]() {
+            for (int i = 0; i < CLICKS; ++i) {
+                incremental.insert(clicks[click++ % clicks.size()]);
+            }
+            sink = sink + incremental.positions().size();
+        });
+
+        std::mt19937 gen(SEED + sites);
+        std::uniform_int_distribution<int> node(0, static_cast<int>(navGraph.size()) - 1);
+        std::vector<std::pair<int, int>> queries(QUERIES);
+        for (auto& query : queries) {
+            query = std::make_pair(node(gen), node(gen));
+        }
+
+        // One context for every query, as in the app
+        SearchContext search;
+        std::vector<int> route;
+        measure("aStar", sites, QUERIES, [&]() {
+            std::streambuf* out = std::cout.rdbuf(&null);
+            std::streambuf* err = std::cerr.rdbuf(&null);
+            for (const auto& query : queries) {
+                search.aStar(navGraph, query.first, query.second, 0.f, route);
+                sink = sink + route.size();
+            }
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+        });
+
+        SafestPath safest;
+        measure("SafestPath::build", sites, 1, [&]() {
+            safest.build(navGraph);
+        });
+
+        measure("SafestPath::bottleneck", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                sink = sink + safest.bottleneck(query.first, query.second);
+            }
+        });
+
+        measure("SafestPath::treePath", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                route.clear();
+                safest.treePath(query.first, query.second, route);
+                sink = sink + route.size();
+            }
+        });
+
+        measure("SafestPath::path", sites, QUERIES, [&]() {
+            std::streambuf* out = std::cout.rdbuf(&null);
+            std::streambuf* err = std::cerr.rdbuf(&null);
+            for (const auto& query : queries) {
+                safest.path(navGraph, search, query.first, query.second, route);
+                sink = sink + route.size();
+            }
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+        });
+
+        // An AI tick: BATCH routes from BATCH_SOURCES starts, one A* each, then
+        // as one PathService batch. Paths per second: 1e9 / ns_per_op
+        std::vector<int> sources(BATCH_SOURCES);
+        for (auto& source : sources) {
+            source = node(gen);
+        }
+        std::uniform_int_distribution<int> pick(0, BATCH_SOURCES - 1);
+        std::vector<std::pair<int, int>> requests(BATCH);
+        for (auto& request : requests) {
+            request = std::make_pair(sources[pick(gen)], node(gen));
+        }
+
+        measure("aStar batch", sites, BATCH, [&]() {
+            std::streambuf* out = std::cout.rdbuf(&null);
+            for (const auto& request : requests) {
+                search.aStar(navGraph, request.first, request.second, 0.f, route);
+                sink = sink + route.size();
+            }
+            std::cout.rdbuf(out);
+        });
+
+        PathBatch paths;
+        for (unsigned threads : THREADS) {
+            if (threads > 1 && threads > maxThreads) {
+                break;
+            }
+            ThreadPool pool(threads);
+            PathService service(pool);
+            const std::string name = "PathService::solve (" + std::to_string(threads) + " threads)";
+            measure(name.c_str(), sites, BATCH, [&]() {
+                std::streambuf* out = std::cout.rdbuf(&null);
+                service.solve(navGraph, requests, 0.f, paths);
+                sink = sink + paths.nodes.size();
+                std::cout.rdbuf(out);
+            });
+        }
+    }
+    endReport();
+
+    return EXIT_SUCCESS;
+}
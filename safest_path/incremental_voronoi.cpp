@@ -0,0 +1,357 @@
+#include "incremental_voronoi.hpp"
+#include <algorithm>
+#include <cmath>
+
+const int IncrementalVoronoi::NONE;
+
+IncrementalVoronoi::IncrementalVoronoi() : edges(sf::Lines) {
+    clear();
+}
+
+void IncrementalVoronoi::clear() {
+    points.clear();
+    triangles.clear();
+    centers.clear();
+    versions.clear();
+    clearances.clear();
+    edges.clear();
+    freeTriangles = NONE;
+    last = NONE;
+    started = false;
+    hints.clear();
+    hintedSites = 0;
+}
+
+bool IncrementalVoronoi::alive(int node) const {
+    return node >= 0 && node < static_cast<int>(triangles.size()) && triangles[node].v[0] != NONE &&
+           triangles[node].v[2] != GHOST;
+}
+
+// Sites are floats: their differences, and the products of two of them, are
+// exact in double
+double IncrementalVoronoi::orient(int a, int b, const sf::Vector2f& c) const {
+    const sf::Vector2f& pa = points[a];
+    const sf::Vector2f& pb = points[b];
+    return (static_cast<double>(pb.x) - pa.x) * (static_cast<double>(c.y) - pa.y) -
+           (static_cast<double>(pb.y) - pa.y) * (static_cast<double>(c.x) - pa.x);
+}
+
+bool IncrementalVoronoi::inCircle(int t, const sf::Vector2f& p) const {
+    const Triangle& triangle = triangles[t];
+    if (triangle.v[2] == GHOST) {
+        // Strictly outside the hull side, or strictly inside it
+        const double side = orient(triangle.v[0], triangle.v[1], p);
+        if (side != 0.0) {
+            return side > 0.0;
+        }
+        const sf::Vector2f& a = points[triangle.v[0]];
+        const sf::Vector2f& b = points[triangle.v[1]];
+        const double along = (static_cast<double>(p.x) - a.x) * (static_cast<double>(b.x) - a.x) +
+                             (static_cast<double>(p.y) - a.y) * (static_cast<double>(b.y) - a.y);
+        const double length = (static_cast<double>(b.x) - a.x) * (static_cast<double>(b.x) - a.x) +
+                              (static_cast<double>(b.y) - a.y) * (static_cast<double>(b.y) - a.y);
+        return along > 0.0 && along < length;
+    }
+
+    double m[3][3];
+    for (int i = 0; i < 3; ++i) {
+        const double dx = static_cast<double>(points[triangle.v[i]].x) - p.x;
+        const double dy = static_cast<double>(points[triangle.v[i]].y) - p.y;
+        m[i][0] = dx;
+        m[i][1] = dy;
+        m[i][2] = dx * dx + dy * dy;
+    }
+    return m[0][0] * (m[1][1] * m[2][2] - m[2][1] * m[1][2]) - m[0][1] * (m[1][0] * m[2][2] - m[2][0] * m[1][2]) +
+               m[0][2] * (m[1][0] * m[2][1] - m[2][0] * m[1][1]) >
+           0.0;
+}
+
+int IncrementalVoronoi::allocate() {
+    int t;
+    if (freeTriangles != NONE) {
+        t = freeTriangles;
+        freeTriangles = triangles[t].n[0];
+    } else {
+        t = static_cast<int>(triangles.size());
+        triangles.push_back(Triangle());
+        centers.emplace_back();
+        versions.push_back(0);
+        clearances.resize(clearances.size() + 3);
+        for (int i = 0; i < 6; ++i) {
+            edges.append(sf::Vertex(sf::Vector2f(), sf::Color::Transparent));
+        }
+    }
+    return t;
+}
+
+void IncrementalVoronoi::release(int t) {
+    triangles[t].v[0] = NONE;
+    versions[t]++;
+    triangles[t].n[0] = freeTriangles;
+    freeTriangles = t;
+    for (int i = 0; i < 6; ++i) {
+        edges[6 * t + i].color = sf::Color::Transparent;
+    }
+}
+
+void IncrementalVoronoi::place(int t) {
+    const Triangle& triangle = triangles[t];
+    if (triangle.v[2] == GHOST) {
+        return;
+    }
+    const sf::Vector2f& a = points[triangle.v[0]];
+    const double bx = static_cast<double>(points[triangle.v[1]].x) - a.x;
+    const double by = static_cast<double>(points[triangle.v[1]].y) - a.y;
+    const double cx = static_cast<double>(points[triangle.v[2]].x) - a.x;
+    const double cy = static_cast<double>(points[triangle.v[2]].y) - a.y;
+    const double d = 2.0 * (bx * cy - by * cx);
+    const double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+    centers[t] = sf::Vector2f(a.x + (cy * b2 - by * c2) / d, a.y + (bx * c2 - cx * b2) / d);
+}
+
+// One line and one clearance per finite neighbor
+void IncrementalVoronoi::link(int t) {
+    const Triangle& triangle = triangles[t];
+    for (int i = 0; i < 3; ++i) {
+        sf::Vertex* line = &edges[6 * t + 2 * i];
+        line[0].color = line[1].color = sf::Color::Transparent;
+        clearances[3 * t + i] = 0.f;
+        if (triangle.v[2] == GHOST || !alive(triangle.n[i])) {
+            continue;
+        }
+        // Computed the same way from both triangles, so both directions of
+        // the edge get the same float
+        const int other = triangle.n[i];
+        const int site = std::min(triangle.v[(i + 1) % 3], triangle.v[(i + 2) % 3]);
+        clearances[3 * t + i] = clearance(centers[std::min(t, other)], centers[std::max(t, other)], points[site]);
+        line[0] = sf::Vertex(centers[t], sf::Color::Red);
+        line[1] = sf::Vertex(centers[other], sf::Color::Red);
+    }
+}
+
+// A node has at most three neighbors, so a single pass fills the rows in
+// order. The sides are read from `clearances` alone, not from the neighbors
+void IncrementalVoronoi::compact(NavGraph& graph) const {
+    graph.positions = centers;
+    graph.offsets.resize(triangles.size() + 1);
+    graph.targets.clear();
+    graph.clearances.clear();
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        graph.offsets[t] = static_cast<uint32_t>(graph.targets.size());
+        if (!alive(static_cast<int>(t))) {
+            continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (clearances[3 * t + i] != 0.f) {
+                graph.targets.push_back(triangles[t].n[i]);
+                graph.clearances.push_back(clearances[3 * t + i]);
+            }
+        }
+    }
+    graph.offsets[triangles.size()] = static_cast<uint32_t>(graph.targets.size());
+}
+
+void IncrementalVoronoi::start() {
+    // Sites 0 to c - 1 are on a line, c is off it
+    const int c = static_cast<int>(points.size()) - 1;
+    int a = 0, b = 1;
+    if (orient(a, b, points[c]) < 0.0) {
+        std::swap(a, b);
+    }
+    const int t = allocate(), ab = allocate(), bc = allocate(), ca = allocate();
+    // Each ghost triangle is a hull side seen from outside; two ghosts
+    // sharing a hull vertex are adjacent through infinity
+    triangles[t] = Triangle{{a, b, c}, {bc, ca, ab}};
+    triangles[ab] = Triangle{{b, a, GHOST}, {ca, bc, t}};
+    triangles[bc] = Triangle{{c, b, GHOST}, {ab, ca, t}};
+    triangles[ca] = Triangle{{a, c, GHOST}, {bc, ab, t}};
+    place(t);
+    link(t);
+    last = t;
+    started = true;
+    rebuildHints();
+
+    for (int i = 2; i < c; ++i) {
+        add(i, locate(points[i]));
+    }
+}
+
+bool IncrementalVoronoi::insert(const sf::Vector2f& site) {
+    if (!started) {
+        if (std::find(points.begin(), points.end(), site) != points.end()) {
+            return false;
+        }
+        points.push_back(site);
+        if (points.size() >= 3 && orient(0, 1, site) != 0.0) {
+            start();
+        }
+        return true;
+    }
+
+    const int t = locate(site);
+    for (int vertex : triangles[t].v) {
+        if (vertex != GHOST && points[vertex] == site) {
+            return false;
+        }
+    }
+    points.push_back(site);
+    add(static_cast<int>(points.size()) - 1, t);
+    return true;
+}
+
+int IncrementalVoronoi::hintCell(const sf::Vector2f& p) const {
+    const float x = (p.x - box.left) / box.width * hintColumns;
+    const float y = (p.y - box.top) / box.height * hintRows;
+    const int column = static_cast<int>(std::min(std::max(x, 0.f), static_cast<float>(hintColumns - 1)));
+    const int row = static_cast<int>(std::min(std::max(y, 0.f), static_cast<float>(hintRows - 1)));
+    return row * hintColumns + column;
+}
+
+void IncrementalVoronoi::rebuildHints() {
+    float left = points[0].x, top = points[0].y, right = left, bottom = top;
+    for (const auto& point : points) {
+        left = std::min(left, point.x);
+        top = std::min(top, point.y);
+        right = std::max(right, point.x);
+        bottom = std::max(bottom, point.y);
+    }
+    box = sf::FloatRect(left, top, std::max(right - left, 1.f), std::max(bottom - top, 1.f));
+    const float cells = static_cast<float>(points.size()) / HINT_SITES;
+    hintColumns = std::max(1, static_cast<int>(std::sqrt(cells * box.width / box.height)));
+    hintRows = std::max(1, static_cast<int>(cells / hintColumns));
+    hints.assign(hintColumns * hintRows, NONE);
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        if (alive(static_cast<int>(t))) {
+            hints[hintCell(points[triangles[t].v[0]])] = static_cast<int>(t);
+        }
+    }
+    hintedSites = points.size();
+}
+
+// Walks from the hint of the cell of `p`, crossing any side that has `p` on
+// its outer side. In a Delaunay triangulation this never loops
+int IncrementalVoronoi::locate(const sf::Vector2f& p) {
+    int t = hints[hintCell(p)];
+    if (t == NONE || triangles[t].v[0] == NONE) {
+        t = last;
+    }
+    if (triangles[t].v[2] == GHOST) {
+        t = triangles[t].n[2];
+    }
+
+    for (;;) {
+        const Triangle& triangle = triangles[t];
+        if (triangle.v[2] == GHOST) {
+            return t;
+        }
+        const int first = static_cast<int>(gen() % 3);
+        int next = NONE;
+        for (int j = 0; j < 3 && next == NONE; ++j) {
+            const int i = (first + j) % 3;
+            if (orient(triangle.v[(i + 1) % 3], triangle.v[(i + 2) % 3], p) < 0.0) {
+                next = triangle.n[i];
+            }
+        }
+        if (next == NONE) {
+            return t;
+        }
+        t = next;
+    }
+}
+
+void IncrementalVoronoi::add(int vertex, int first) {
+    const sf::Vector2f p = points[vertex];
+    inCavity.resize(triangles.size(), 0);
+    cavity.clear();
+    cavity.push_back(first);
+    inCavity[first] = 1;
+    for (size_t i = 0; i < cavity.size(); ++i) {
+        for (int neighbor : triangles[cavity[i]].n) {
+            if (!inCavity[neighbor] && inCircle(neighbor, p)) {
+                inCavity[neighbor] = 1;
+                cavity.push_back(neighbor);
+            }
+        }
+    }
+
+    // Every side must see the new site on its inner side, or its fan
+    // triangle would be flipped: a rounding error in inCircle, fixed by
+    // taking the triangle across into the cavity
+    for (;;) {
+        boundary.clear();
+        int grow = NONE;
+        for (int t : cavity) {
+            const Triangle& triangle = triangles[t];
+            for (int i = 0; i < 3; ++i) {
+                if (inCavity[triangle.n[i]]) {
+                    continue;
+                }
+                const int from = triangle.v[(i + 1) % 3], to = triangle.v[(i + 2) % 3];
+                if (from != GHOST && to != GHOST && orient(from, to, p) <= 0.0) {
+                    grow = triangle.n[i];
+                }
+                boundary.push_back(Side{from, to, triangle.n[i]});
+            }
+        }
+        if (grow == NONE) {
+            break;
+        }
+        inCavity[grow] = 1;
+        cavity.push_back(grow);
+    }
+
+    // The cavity ids are released first, so the fan reuses them
+    for (int t : cavity) {
+        inCavity[t] = 0;
+        release(t);
+    }
+    created.clear();
+    startingAt.clear();
+    for (const Side& side : boundary) {
+        const int t = allocate();
+        Triangle& triangle = triangles[t];
+        // Rotated to keep GHOST last
+        if (side.from == GHOST) {
+            triangle = Triangle{{side.to, vertex, GHOST}, {NONE, side.outer, NONE}};
+        } else if (side.to == GHOST) {
+            triangle = Triangle{{vertex, side.from, GHOST}, {side.outer, NONE, NONE}};
+        } else {
+            triangle = Triangle{{side.from, side.to, vertex}, {NONE, NONE, side.outer}};
+        }
+        Triangle& outer = triangles[side.outer];
+        for (int i = 0; i < 3; ++i) {
+            if (outer.v[(i + 1) % 3] == side.to && outer.v[(i + 2) % 3] == side.from) {
+                outer.n[i] = t;
+            }
+        }
+        startingAt.emplace_back(side.from, static_cast<int>(created.size()));
+        created.push_back(t);
+    }
+
+    // The fan triangles of (from, to) and of (to, next) share the side from
+    // `to` to the new site
+    auto index = [&](const Triangle& triangle, int v) {
+        return triangle.v[0] == v ? 0 : triangle.v[1] == v ? 1 : 2;
+    };
+    std::sort(startingAt.begin(), startingAt.end());
+    for (size_t k = 0; k < created.size(); ++k) {
+        const int next = std::lower_bound(startingAt.begin(), startingAt.end(), std::make_pair(boundary[k].to, 0))->second;
+        Triangle& triangle = triangles[created[k]];
+        Triangle& following = triangles[created[next]];
+        triangle.n[index(triangle, boundary[k].from)] = created[next];
+        following.n[index(following, boundary[next].to)] = created[k];
+    }
+
+    for (int t : created) {
+        place(t);
+    }
+    for (size_t k = 0; k < created.size(); ++k) {
+        link(created[k]);
+        link(boundary[k].outer);
+    }
+    last = created[0];
+    hints[hintCell(p)] = last;
+    if (points.size() >= 4 * hintedSites) {
+        rebuildHints();
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef INCREMENTAL_VORONOI_HPP
+#define INCREMENTAL_VORONOI_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "nav_graph.hpp"
+
+// Voronoi graph kept up to date one site at a time. The graph is the dual of
+// a Delaunay triangulation grown with Bowyer-Watson: a Voronoi vertex is the
+// circumcenter of a triangle, a primary edge joins the circumcenters of two
+// adjacent triangles. Inserting a site only replaces the triangles whose
+// circumcircle contains it, a handful on average, so only their nodes and
+// the edges around them are patched; every other node keeps its id.
+// The hull is closed with ghost triangles sharing a vertex at infinity, so
+// sites outside the current hull need no special case. Ghost triangles are
+// not graph nodes: their edges are the infinite rays, left out as in
+// buildVoronoiGraph.
+class IncrementalVoronoi {
+public:
+    IncrementalVoronoi();
+    void clear();
+
+    // false if the site is already there. O(cavity) once located, and the
+    // location walks a few triangles from the hint of its cell: O(1) on
+    // average for sites spread about evenly
+    bool insert(const sf::Vector2f& site);
+
+    const std::vector<sf::Vector2f>& sites() const { return points; }
+    // Node positions, indexed by node id. An id is stable until the insert
+    // that destroys its triangle, and destroyed ids are reused, often by the
+    // same insert
+    const std::vector<sf::Vector2f>& positions() const { return centers; }
+    bool alive(int node) const;
+    // Bumped each time the id is destroyed: a node kept across inserts is
+    // still the same one if it is alive with the same version
+    uint32_t version(int node) const { return versions[node]; }
+    // The graph in `graph`, same node ids, dead nodes without edges. O(nodes),
+    // one sequential pass over the positions and the side clearances
+    void compact(NavGraph& graph) const;
+    // Primary edges, a pair of vertices per node side, transparent when
+    // there is no edge. Each edge is drawn from both of its nodes
+    const sf::VertexArray& lines() const { return edges; }
+
+private:
+    static const int GHOST = -1; // vertex at infinity
+    static const int NONE = -1;
+    static const int HINT_SITES = 2;
+
+    struct Triangle {
+        int v[3]; // counterclockwise, GHOST only as v[2]; v[0] == NONE in the free list
+        int n[3]; // n[i] across the side opposite v[i]; n[0] is the next free triangle in the free list
+    };
+
+    // A side of the cavity of an insert
+    struct Side {
+        int from, to; // counterclockwise around the cavity
+        int outer;    // triangle across, kept
+    };
+
+    // > 0 if c is left of a -> b
+    double orient(int a, int b, const sf::Vector2f& c) const;
+    // Is `p` strictly inside the circumcircle of t, or for a ghost triangle
+    // strictly outside its hull side
+    bool inCircle(int t, const sf::Vector2f& p) const;
+    // A triangle whose circumcircle contains `p`
+    int locate(const sf::Vector2f& p);
+    int hintCell(const sf::Vector2f& p) const;
+    // Grid of about HINT_SITES sites per cell over the box of the sites,
+    // redone each time the sites have quadrupled, O(n) amortized to O(1)
+    void rebuildHints();
+    // Bowyer-Watson step: replaces the triangles whose circumcircle contains
+    // site `vertex`, starting from `first`, by a fan around it
+    void add(int vertex, int first);
+    int allocate();
+    void release(int t);
+    // Node of t at its circumcenter
+    void place(int t);
+    // Lines and clearances of the node of t, once its neighbors are placed
+    void link(int t);
+    // The first triangle, once a site is off the line of the first two
+    void start();
+
+    std::vector<sf::Vector2f> points;
+    std::vector<Triangle> triangles;
+    int freeTriangles;
+    int last; // a triangle of the last insert, where the next walk may start
+    bool started;
+
+    std::vector<sf::Vector2f> centers; // circumcenter per triangle
+    std::vector<uint32_t> versions;    // per triangle, releases so far
+    // Per triangle side i, clearance of the edge to n[i]. 0 without an edge,
+    // as a site is never on the boundary of its own cell
+    std::vector<float> clearances;
+    sf::VertexArray edges;
+
+    // A recent triangle per cell, maybe dead since, where walks start
+    sf::FloatRect box;
+    int hintColumns, hintRows;
+    std::vector<int> hints;
+    size_t hintedSites; // sites when the grid was made
+
+    std::mt19937 gen; // order of the sides tried by a walk
+    // Buffers of insert
+    std::vector<int> cavity;
+    std::vector<char> inCavity;
+    std::vector<Side> boundary;
+    std::vector<int> created;
+    std::vector<std::pair<int, int>> startingAt; // `from` and index in boundary, sorted
+};
+
+#endif // INCREMENTAL_VORONOI_HPP
@@ -0,0 +1,41 @@
+#ifndef NAV_GRAPH_HPP
+#define NAV_GRAPH_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Graph searched by SearchContext and SafestPath, in compressed sparse row
+// form: the edges leaving node i are targets[k] and clearances[k] for k in
+// [offsets[i], offsets[i + 1]). Each array is contiguous, so a search reads a
+// node's edges in one run instead of chasing a vector per node. Every edge is
+// stored once in each direction, without parallel copies
+struct NavGraph {
+    std::vector<sf::Vector2f> positions;
+    std::vector<uint32_t> offsets; // size() + 1 entries
+    std::vector<int> targets;
+    std::vector<float> clearances; // > 0, see clearance()
+
+    size_t size() const { return positions.size(); }
+
+    void clear() {
+        positions.clear();
+        offsets.assign(1, 0);
+        targets.clear();
+        clearances.clear();
+    }
+};
+
+// Smallest distance from the Voronoi edge a-b to the sites it separates,
+// measured to either one of them since the edge is on their bisector: the
+// distance from `site` to the closest point of the segment
+inline float clearance(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& site) {
+    const float dx = b.x - a.x, dy = b.y - a.y;
+    const float length2 = dx * dx + dy * dy;
+    float t = length2 > 0.f ? ((site.x - a.x) * dx + (site.y - a.y) * dy) / length2 : 0.f;
+    t = t < 0.f ? 0.f : t > 1.f ? 1.f : t;
+    return std::hypot(a.x + t * dx - site.x, a.y + t * dy - site.y);
+}
+
+#endif // NAV_GRAPH_HPP
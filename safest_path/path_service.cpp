@@ -0,0 +1,66 @@
+#include "path_service.hpp"
+#include "search_context.hpp"
+#include <algorithm>
+
+PathService::PathService(ThreadPool& pool) : pool(pool) {}
+
+void PathService::solve(const NavGraph& graph, const std::vector<std::pair<int, int>>& requests, float minClearance,
+                        PathBatch& batch) {
+    order.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return requests[a].first < requests[b].first;
+    });
+    goals.resize(order.size());
+    groups.clear();
+    for (size_t i = 0; i < order.size(); ++i) {
+        goals[i] = requests[order[i]].second;
+        if (i == 0 || requests[order[i]].first != requests[order[i - 1]].first) {
+            groups.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    groups.push_back(static_cast<uint32_t>(order.size()));
+    const size_t groupCount = groups.size() - 1;
+    if (groupNodes.size() < groupCount) {
+        groupNodes.resize(groupCount);
+    }
+    slices.resize(requests.size());
+    batch.lengths.resize(requests.size());
+
+    pool.parallelFor(groupCount, [&](size_t group) {
+        thread_local SearchContext search;
+        thread_local std::vector<int> scratch;
+        const uint32_t first = groups[group], last = groups[group + 1];
+        const int start = requests[order[first]].first;
+        if (std::all_of(goals.begin() + first, goals.begin() + last, [&](int goal) { return goal == goals[first]; })) {
+            search.aStar(graph, start, goals[first], minClearance, scratch);
+        } else {
+            search.dijkstra(graph, start, goals.data() + first, last - first, minClearance);
+        }
+
+        std::vector<int>& nodes = groupNodes[group];
+        nodes.clear();
+        for (uint32_t i = first; i < last; ++i) {
+            const uint32_t offset = static_cast<uint32_t>(nodes.size());
+            batch.lengths[order[i]] = search.pathTo(goals[i], nodes);
+            slices[order[i]] = Slice{offset, static_cast<uint32_t>(nodes.size()) - offset};
+        }
+    });
+
+    // Gathered in request order into one buffer
+    batch.offsets.resize(requests.size() + 1);
+    batch.offsets[0] = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        batch.offsets[i + 1] = batch.offsets[i] + slices[i].count;
+    }
+    batch.nodes.resize(batch.offsets.back());
+    pool.parallelFor(groupCount, [&](size_t group) {
+        for (uint32_t i = groups[group]; i < groups[group + 1]; ++i) {
+            const Slice& slice = slices[order[i]];
+            std::copy_n(groupNodes[group].begin() + slice.offset, slice.count,
+                        batch.nodes.begin() + batch.offsets[order[i]]);
+        }
+    });
+}
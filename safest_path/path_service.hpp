@@ -0,0 +1,46 @@
+#ifndef PATH_SERVICE_HPP
+#define PATH_SERVICE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "nav_graph.hpp"
+#include "thread_pool.hpp"
+
+// Routes of a batch, in the order of the requests: route i is
+// nodes[offsets[i]..offsets[i + 1]), empty when there is none
+struct PathBatch {
+    std::vector<uint32_t> offsets;
+    std::vector<int> nodes;
+    std::vector<float> lengths; // infinite when there is no route
+};
+
+// Many routes at once, for agents that all ask for theirs in the same tick.
+// Requests sharing a start are one search: A* when they also share the goal,
+// else a Dijkstra run that stops at the last of their goals. The searches
+// are spread over the pool, each thread with its own SearchContext.
+class PathService {
+public:
+    explicit PathService(ThreadPool& pool);
+
+    // Shortest routes by edge length for (start, goal) `requests`, only
+    // through edges of at least `minClearance`
+    void solve(const NavGraph& graph, const std::vector<std::pair<int, int>>& requests, float minClearance,
+               PathBatch& batch);
+
+private:
+    // Route of a request in the nodes of its group
+    struct Slice {
+        uint32_t offset, count;
+    };
+
+    ThreadPool& pool;
+
+    std::vector<uint32_t> order;   // requests by start
+    std::vector<int> goals;        // goal of order[i]
+    std::vector<uint32_t> groups;  // first index in `order` of each start, then order.size()
+    std::vector<std::vector<int>> groupNodes;
+    std::vector<Slice> slices;     // by request
+};
+
+#endif // PATH_SERVICE_HPP
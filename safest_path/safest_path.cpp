@@ -0,0 +1,183 @@
+#include "safest_path.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const int SafestPath::NONE;
+
+SafestPath::SafestPath() : nodes(0) {}
+
+int SafestPath::find(int set) {
+    while (sets[set] != set) {
+        sets[set] = sets[sets[set]];
+        set = sets[set];
+    }
+    return set;
+}
+
+void SafestPath::build(const NavGraph& graph) {
+    nodes = static_cast<int>(graph.size());
+
+    edges.clear();
+    for (int u = 0; u < nodes; ++u) {
+        for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            const int v = graph.targets[e];
+            if (u < v) {
+                const sf::Vector2f step = graph.positions[v] - graph.positions[u];
+                edges.push_back(Edge{u, v, graph.clearances[e], std::sqrt(step.x * step.x + step.y * step.y)});
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        return a.clearance > b.clearance || (a.clearance == b.clearance && a.length < b.length);
+    });
+
+    // Kruskal, keeping the spanning forest edges at the front of `edges`
+    parent.assign(nodes, NONE);
+    value.assign(nodes, std::numeric_limits<float>::infinity());
+    children.clear();
+    sets.resize(nodes);
+    sizes.assign(nodes, 1);
+    top.resize(nodes);
+    for (int u = 0; u < nodes; ++u) {
+        sets[u] = u;
+        top[u] = u;
+    }
+    size_t kept = 0;
+    for (const Edge& edge : edges) {
+        int a = find(edge.from), b = find(edge.to);
+        if (a == b) {
+            continue;
+        }
+        const int joined = static_cast<int>(parent.size());
+        parent.push_back(NONE);
+        value.push_back(edge.clearance);
+        parent[top[a]] = parent[top[b]] = joined;
+        children.push_back(top[a]);
+        children.push_back(top[b]);
+        if (sizes[a] < sizes[b]) {
+            std::swap(a, b);
+        }
+        sets[b] = a;
+        sizes[a] += sizes[b];
+        top[a] = joined;
+        edges[kept++] = edge;
+    }
+
+    // Heavy-light decomposition, parents before their children: ids down
+    const int total = static_cast<int>(parent.size());
+    sizes.assign(total, 1);
+    for (int k = nodes; k < total; ++k) {
+        sizes[k] = sizes[children[2 * (k - nodes)]] + sizes[children[2 * (k - nodes) + 1]];
+    }
+    head.resize(total);
+    depth.resize(total);
+    for (int k = total - 1; k >= 0; --k) {
+        if (parent[k] == NONE) {
+            head[k] = k;
+            depth[k] = 0;
+        }
+        if (k >= nodes) {
+            int heavy = children[2 * (k - nodes)], light = children[2 * (k - nodes) + 1];
+            if (sizes[heavy] < sizes[light]) {
+                std::swap(heavy, light);
+            }
+            head[heavy] = head[k];
+            head[light] = light;
+            depth[heavy] = depth[light] = depth[k] + 1;
+        }
+    }
+
+    // Spanning forest rooted by a breadth-first walk
+    offsets.assign(nodes + 1, 0);
+    for (size_t i = 0; i < kept; ++i) {
+        offsets[edges[i].from + 1]++;
+        offsets[edges[i].to + 1]++;
+    }
+    for (int u = 0; u < nodes; ++u) {
+        offsets[u + 1] += offsets[u];
+    }
+    adjacent.resize(2 * kept);
+    for (size_t i = 0; i < kept; ++i) {
+        adjacent[offsets[edges[i].from]++] = edges[i].to;
+        adjacent[offsets[edges[i].to]++] = edges[i].from;
+    }
+    for (int u = nodes; u > 0; --u) {
+        offsets[u] = offsets[u - 1];
+    }
+    offsets[0] = 0;
+
+    treeParent.assign(nodes, NONE);
+    treeDepth.assign(nodes, NONE);
+    for (int root = 0; root < nodes; ++root) {
+        if (treeDepth[root] != NONE) {
+            continue;
+        }
+        treeDepth[root] = 0;
+        queue.assign(1, root);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            const int u = queue[i];
+            for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                const int v = adjacent[e];
+                if (treeDepth[v] == NONE) {
+                    treeParent[v] = u;
+                    treeDepth[v] = treeDepth[u] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+    }
+}
+
+// A root path crosses O(log n) light edges, so O(log n) chain jumps
+int SafestPath::ancestor(int a, int b) const {
+    while (head[a] != head[b]) {
+        if (depth[head[a]] < depth[head[b]]) {
+            std::swap(a, b);
+        }
+        a = parent[head[a]];
+        if (a == NONE) {
+            return NONE;
+        }
+    }
+    return depth[a] < depth[b] ? a : b;
+}
+
+float SafestPath::bottleneck(int from, int to) const {
+    const int lowest = ancestor(from, to);
+    return lowest == NONE ? 0.f : value[lowest];
+}
+
+void SafestPath::treePath(int from, int to, std::vector<int>& path) const {
+    if (ancestor(from, to) == NONE) {
+        return;
+    }
+    // Their meeting node first, then each end climbs to it; the part from
+    // `to` is climbed backwards and reversed in place
+    int a = from, b = to;
+    while (a != b) {
+        if (treeDepth[a] >= treeDepth[b]) {
+            a = treeParent[a];
+        } else {
+            b = treeParent[b];
+        }
+    }
+    for (; from != a; from = treeParent[from]) {
+        path.push_back(from);
+    }
+    path.push_back(a);
+    const size_t back = path.size();
+    for (; to != a; to = treeParent[to]) {
+        path.push_back(to);
+    }
+    std::reverse(path.begin() + back, path.end());
+}
+
+bool SafestPath::path(const NavGraph& graph, SearchContext& search, int from, int to, std::vector<int>& path) const {
+    const float least = bottleneck(from, to);
+    if (least == 0.f) {
+        path.clear();
+        return false;
+    }
+    return search.aStar(graph, from, to, least, path);
+}
@@ -0,0 +1,69 @@
+#ifndef SAFEST_PATH_HPP
+#define SAFEST_PATH_HPP
+
+#include <vector>
+#include "nav_graph.hpp"
+#include "search_context.hpp"
+
+// Routes that keep as far as possible from every site. The safest route
+// between two nodes maximizes the smallest clearance of its edges, its
+// bottleneck; among those, the shortest is preferred.
+// A maximum spanning forest holds a safest route between any two nodes. It
+// is grown by Kruskal, edges by decreasing clearance and shorter first on a
+// tie. Each union also adds a parent to the two trees it joins, holding the
+// clearance of its edge: in this Kruskal reconstruction tree the bottleneck
+// of two nodes is the value of their lowest common ancestor, found by
+// heavy-light decomposition in O(log n) time and O(n) memory.
+class SafestPath {
+public:
+    SafestPath();
+    // O(E log E), for the graph as it is now: rebuild after a change
+    void build(const NavGraph& graph);
+
+    // Largest smallest clearance of a route from `from` to `to`: infinite if
+    // they are the same node, 0 if no route joins them. O(log n)
+    float bottleneck(int from, int to) const;
+    // A safest route, the one in the spanning forest, appended to `path`;
+    // nothing if there is none. O(its length)
+    void treePath(int from, int to, std::vector<int>& path) const;
+    // The shortest of the safest routes in `path`: A* through the edges of
+    // at least the bottleneck. false and an empty path if there is none
+    bool path(const NavGraph& graph, SearchContext& search, int from, int to, std::vector<int>& path) const;
+
+private:
+    static const int NONE = -1;
+
+    struct Edge {
+        int from, to;
+        float clearance, length;
+    };
+
+    // Union-find with path halving
+    int find(int set);
+    // Lowest common ancestor in the reconstruction tree, NONE in two trees
+    int ancestor(int a, int b) const;
+
+    int nodes;
+    // Reconstruction tree: ids below `nodes` are the graph nodes, then one
+    // per union, always above its two children
+    std::vector<int> parent;
+    std::vector<int> children; // two per union
+    std::vector<float> value;  // clearance of the union, infinite for a graph node
+    std::vector<int> head;     // top of the heavy chain
+    std::vector<int> depth;
+
+    // Spanning forest, each tree rooted at its first node
+    std::vector<int> treeParent;
+    std::vector<int> treeDepth;
+
+    // Buffers of build
+    std::vector<Edge> edges;
+    std::vector<int> sets;
+    std::vector<int> sizes;
+    std::vector<int> top; // reconstruction tree root of a set
+    std::vector<uint32_t> offsets;
+    std::vector<int> adjacent; // spanning forest, in CSR form
+    std::vector<int> queue;
+};
+
+#endif // SAFEST_PATH_HPP
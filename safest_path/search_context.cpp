@@ -0,0 +1,209 @@
+#include "search_context.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef ASTAR_TRACE
+#include <iostream>
+#endif
+
+const int SearchContext::OUTSIDE;
+const int SearchContext::CLOSED;
+
+SearchContext::SearchContext() : generation(0) {}
+
+SearchContext::Record& SearchContext::touch(int node) {
+    Record& record = records[node];
+    if (record.generation != generation) {
+        record = Record{generation, std::numeric_limits<float>::infinity(), -1, OUTSIDE};
+    }
+    return record;
+}
+
+void SearchContext::siftUp(int position) {
+    const Open moved = heap[position];
+    while (position > 0) {
+        const int above = (position - 1) / 4;
+        if (heap[above].f <= moved.f) {
+            break;
+        }
+        heap[position] = heap[above];
+        records[heap[position].node].position = position;
+        position = above;
+    }
+    heap[position] = moved;
+    records[moved.node].position = position;
+}
+
+void SearchContext::siftDown(int position) {
+    const Open moved = heap[position];
+    const int count = static_cast<int>(heap.size());
+    for (;;) {
+        const int first = 4 * position + 1;
+        if (first >= count) {
+            break;
+        }
+        int least = first;
+        for (int child = first + 1; child < std::min(first + 4, count); ++child) {
+            if (heap[child].f < heap[least].f) {
+                least = child;
+            }
+        }
+        if (heap[least].f >= moved.f) {
+            break;
+        }
+        heap[position] = heap[least];
+        records[heap[position].node].position = position;
+        position = least;
+    }
+    heap[position] = moved;
+    records[moved.node].position = position;
+}
+
+void SearchContext::begin(const NavGraph& graph, int start, float f) {
+    if (records.size() < graph.size()) {
+        records.resize(graph.size(), Record{generation, 0.f, -1, OUTSIDE});
+        goalGenerations.resize(graph.size(), generation);
+    }
+    if (++generation == 0) {
+        // Wrapped around: old records could pass for current ones
+        for (Record& record : records) {
+            record.generation = 0;
+        }
+        std::fill(goalGenerations.begin(), goalGenerations.end(), 0);
+        generation = 1;
+    }
+    heap.clear();
+    touch(start).g = 0.f;
+    push(start, f);
+}
+
+void SearchContext::push(int node, float f) {
+    const int position = records[node].position;
+    if (position == OUTSIDE) {
+        heap.push_back(Open{f, node});
+        siftUp(static_cast<int>(heap.size()) - 1);
+    } else {
+        heap[position].f = f;
+        siftUp(position);
+    }
+}
+
+int SearchContext::pop() {
+    const int node = heap[0].node;
+    heap[0] = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        siftDown(0);
+    }
+    records[node].position = CLOSED;
+
+#ifdef ASTAR_TRACE
+    std::cout << "Processing node " << node << std::endl;
+#endif
+    return node;
+}
+
+// The heuristic is the straight distance and the edges cost their length:
+// it is consistent, so an expanded node is final
+bool SearchContext::aStar(const NavGraph& graph, int start, int end, float minClearance, std::vector<int>& path) {
+    path.clear();
+#ifdef ASTAR_TRACE
+    std::cout << "Starting A* from node " << start << " to node " << end << std::endl;
+#endif
+
+    const sf::Vector2f goal = graph.positions[end];
+    auto heuristic = [&](int node) {
+        const sf::Vector2f d = graph.positions[node] - goal;
+        return std::sqrt(d.x * d.x + d.y * d.y);
+    };
+
+    begin(graph, start, heuristic(start));
+    while (!heap.empty()) {
+        const int current = pop();
+        if (current == end) {
+            pathTo(end, path);
+            return true;
+        }
+
+        const float g = records[current].g;
+        const sf::Vector2f from = graph.positions[current];
+        for (uint32_t edge = graph.offsets[current]; edge < graph.offsets[current + 1]; ++edge) {
+            if (graph.clearances[edge] < minClearance) {
+                continue;
+            }
+            const int neighbor = graph.targets[edge];
+            Record& record = touch(neighbor);
+            if (record.position == CLOSED) {
+                continue;
+            }
+            const sf::Vector2f step = graph.positions[neighbor] - from;
+            const float tentative = g + std::sqrt(step.x * step.x + step.y * step.y);
+            if (tentative >= record.g) {
+                continue;
+            }
+            record.g = tentative;
+            record.cameFrom = current;
+            push(neighbor, tentative + heuristic(neighbor));
+        }
+    }
+
+#ifdef ASTAR_TRACE
+    std::cout << "No path found!" << std::endl;
+#endif
+    return false;
+}
+
+void SearchContext::dijkstra(const NavGraph& graph, int start, const int* goals, size_t count, float minClearance) {
+    begin(graph, start, 0.f);
+    size_t remaining = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (goalGenerations[goals[i]] != generation) {
+            goalGenerations[goals[i]] = generation;
+            remaining++;
+        }
+    }
+    if (remaining == 0) {
+        return;
+    }
+
+    while (!heap.empty()) {
+        const int current = pop();
+        if (goalGenerations[current] == generation && --remaining == 0) {
+            return;
+        }
+
+        const float g = records[current].g;
+        const sf::Vector2f from = graph.positions[current];
+        for (uint32_t edge = graph.offsets[current]; edge < graph.offsets[current + 1]; ++edge) {
+            if (graph.clearances[edge] < minClearance) {
+                continue;
+            }
+            const int neighbor = graph.targets[edge];
+            Record& record = touch(neighbor);
+            if (record.position == CLOSED) {
+                continue;
+            }
+            const sf::Vector2f step = graph.positions[neighbor] - from;
+            const float tentative = g + std::sqrt(step.x * step.x + step.y * step.y);
+            if (tentative >= record.g) {
+                continue;
+            }
+            record.g = tentative;
+            record.cameFrom = current;
+            push(neighbor, tentative);
+        }
+    }
+}
+
+float SearchContext::pathTo(int node, std::vector<int>& path) const {
+    const Record& record = records[node];
+    if (record.generation != generation || record.position != CLOSED) {
+        return std::numeric_limits<float>::infinity();
+    }
+    const size_t first = path.size();
+    for (int at = node; at != -1; at = records[at].cameFrom) {
+        path.push_back(at);
+    }
+    std::reverse(path.begin() + first, path.end());
+    return record.g;
+}
@@ -0,0 +1,65 @@
+#ifndef SEARCH_CONTEXT_HPP
+#define SEARCH_CONTEXT_HPP
+
+#include <cstdint>
+#include <vector>
+#include "nav_graph.hpp"
+
+// State of A* kept from one query to the next, so a query allocates nothing
+// once the buffers have grown to the graph. Node records carry the
+// generation of the query that last touched them: a record from an older
+// query reads as untouched, so starting a query is O(1) instead of
+// refilling arrays of the size of the graph. The open set is an indexed
+// 4-ary heap with decrease-key: each node is in it at most once.
+// Not thread-safe: one context per thread.
+// Build with -DASTAR_TRACE to print every expansion.
+class SearchContext {
+public:
+    SearchContext();
+
+    // Shortest path by edge length from `start` to `end`, only through edges
+    // of at least `minClearance`, in `path`. false and an empty path if there
+    // is none
+    bool aStar(const NavGraph& graph, int start, int end, float minClearance, std::vector<int>& path);
+    // Shortest paths by edge length from `start` to every one of the `count`
+    // goals, only through edges of at least `minClearance`: a Dijkstra run
+    // that stops once all the goals are reached. Read them with pathTo
+    void dijkstra(const NavGraph& graph, int start, const int* goals, size_t count, float minClearance);
+    // After a search, the path found to `node` appended to `path`, and its
+    // length; infinite and nothing appended if the search did not reach it
+    float pathTo(int node, std::vector<int>& path) const;
+
+private:
+    static const int OUTSIDE = -1; // not in the heap yet
+    static const int CLOSED = -2;  // expanded
+
+    struct Record {
+        uint32_t generation;
+        float g;
+        int cameFrom;
+        int position; // in heap, or OUTSIDE or CLOSED
+    };
+
+    struct Open {
+        float f;
+        int node;
+    };
+
+    // New query from `start`
+    void begin(const NavGraph& graph, int start, float f);
+    // Record of `node` for this query, reset if it is from an older one
+    Record& touch(int node);
+    // Closes the node at the top of the heap and returns it
+    int pop();
+    // Puts `node` in the heap with key f, or lowers its key to f
+    void push(int node, float f);
+    void siftUp(int position);
+    void siftDown(int position);
+
+    uint32_t generation;
+    std::vector<Record> records;
+    std::vector<Open> heap;
+    std::vector<uint32_t> goalGenerations; // of the dijkstra that has the node as a goal
+};
+
+#endif // SEARCH_CONTEXT_HPP
@@ -0,0 +1,359 @@
+// Checks of the graph, safest path and search code against slow references:
+// brute force over the sites for IncrementalVoronoi, a widest path Dijkstra
+// for SafestPath, a plain Dijkstra for SearchContext and PathService.
+// Usage: ./verify [sites], or make check. Exits with a failure if any check fails.
+#include "voronoi.hpp"
+#include "incremental_voronoi.hpp"
+#include "safest_path.hpp"
+#include "search_context.hpp"
+#include "path_service.hpp"
+#include "thread_pool.hpp"
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1920;
+const int HEIGHT = 1080;
+const unsigned SEED = 12345;
+const int QUERIES = 300;
+const float INFINITE = std::numeric_limits<float>::infinity();
+
+int failures = 0;
+
+void expect(bool ok, const std::string& what) {
+    if (!ok) {
+        if (failures < 20) {
+            std::cerr << "FAIL " << what << std::endl;
+        }
+        failures++;
+    }
+}
+
+bool close(float a, float b) {
+    return a == b || std::abs(a - b) <= 1e-4f * std::max(std::abs(a), std::abs(b));
+}
+
+float distance(const sf::Vector2f& a, const sf::Vector2f& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// Clearance of the edge u -> v, -1 if there is none
+float edgeClearance(const NavGraph& graph, int u, int v) {
+    for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+        if (graph.targets[e] == v) {
+            return graph.clearances[e];
+        }
+    }
+    return -1.f;
+}
+
+// Smallest clearance along `path` from `from` to `to`, -1 if it is not a
+// route of the graph through edges of at least `minClearance`
+float routeClearance(const NavGraph& graph, const std::vector<int>& path, int from, int to, float minClearance) {
+    if (path.empty() || path.front() != from || path.back() != to) {
+        return -1.f;
+    }
+    float least = INFINITE;
+    for (size_t i = 1; i < path.size(); ++i) {
+        const float c = edgeClearance(graph, path[i - 1], path[i]);
+        if (c < minClearance) {
+            return -1.f;
+        }
+        least = std::min(least, c);
+    }
+    return least;
+}
+
+float routeLength(const NavGraph& graph, const std::vector<int>& path) {
+    float length = 0.f;
+    for (size_t i = 1; i < path.size(); ++i) {
+        length += distance(graph.positions[path[i - 1]], graph.positions[path[i]]);
+    }
+    return length;
+}
+
+// Dijkstra from `start` with a binary heap and fresh arrays. `better`
+// decides whether a value through u improves on the one of v, `through`
+// gives it from the value of u and the edge
+std::vector<float> reference(const NavGraph& graph, int start, float initial, float unreached,
+                             const std::function<float(float, int, uint32_t)>& through,
+                             const std::function<bool(float, float)>& better) {
+    std::vector<float> values(graph.size(), unreached);
+    std::vector<char> done(graph.size(), 0);
+    auto worse = [&better](const std::pair<float, int>& a, const std::pair<float, int>& b) { return better(b.first, a.first); };
+    std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int>>, decltype(worse)> open(worse);
+    values[start] = initial;
+    open.push(std::make_pair(initial, start));
+    while (!open.empty()) {
+        const int u = open.top().second;
+        open.pop();
+        if (done[u]) {
+            continue;
+        }
+        done[u] = 1;
+        for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            const int v = graph.targets[e];
+            const float value = through(values[u], u, e);
+            if (!done[v] && better(value, values[v])) {
+                values[v] = value;
+                open.push(std::make_pair(value, v));
+            }
+        }
+    }
+    return values;
+}
+
+// Shortest lengths from `start` through edges of at least `minClearance`
+std::vector<float> shortest(const NavGraph& graph, int start, float minClearance) {
+    return reference(graph, start, 0.f, INFINITE,
+                     [&graph, minClearance](float g, int u, uint32_t e) {
+                         return graph.clearances[e] < minClearance
+                                    ? INFINITE
+                                    : g + distance(graph.positions[u], graph.positions[graph.targets[e]]);
+                     },
+                     [](float a, float b) { return a < b; });
+}
+
+// Widest path: largest smallest clearance of a route from `start`
+std::vector<float> widest(const NavGraph& graph, int start) {
+    return reference(graph, start, INFINITE, 0.f,
+                     [&graph](float width, int, uint32_t e) { return std::min(width, graph.clearances[e]); },
+                     [](float a, float b) { return a > b; });
+}
+
+// Every node is a Voronoi vertex: at least three sites are at its distance
+// and none closer. Every edge is on a bisector: its clearance is the
+// distance to the nearest site of the segment. Both sides of an edge agree
+void checkGraph(const NavGraph& graph, const std::vector<sf::Vector2f>& sites, const std::string& name) {
+    for (size_t u = 0; u < graph.size(); ++u) {
+        if (graph.offsets[u] == graph.offsets[u + 1]) {
+            continue; // dead node
+        }
+        float nearest = INFINITE;
+        for (const auto& site : sites) {
+            nearest = std::min(nearest, distance(graph.positions[u], site));
+        }
+        int onCircle = 0;
+        for (const auto& site : sites) {
+            onCircle += distance(graph.positions[u], site) <= nearest + 1e-3f * std::max(1.f, nearest);
+        }
+        expect(onCircle >= 3, name + ": node " + std::to_string(u) + " is not a Voronoi vertex");
+
+        for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            const int v = graph.targets[e];
+            float least = INFINITE;
+            for (const auto& site : sites) {
+                least = std::min(least, clearance(graph.positions[u], graph.positions[v], site));
+            }
+            expect(std::abs(graph.clearances[e] - least) <= 1e-3f * std::max(1.f, least),
+                   name + ": clearance of " + std::to_string(u) + "-" + std::to_string(v));
+            expect(edgeClearance(graph, v, static_cast<int>(u)) == graph.clearances[e],
+                   name + ": edge " + std::to_string(u) + "-" + std::to_string(v) + " one way");
+        }
+    }
+}
+
+size_t liveNodes(const NavGraph& graph) {
+    size_t count = 0;
+    for (size_t u = 0; u < graph.size(); ++u) {
+        count += graph.offsets[u] != graph.offsets[u + 1];
+    }
+    return count;
+}
+
+// IncrementalVoronoi against brute force, and against boost on sites in
+// general position. A node kept alive with the same version keeps its place
+void checkIncremental(int count) {
+    const std::vector<sf::Vector2f> points = randomPoints(count, SEED + count, WIDTH, HEIGHT);
+    IncrementalVoronoi incremental;
+    NavGraph graph;
+    std::vector<sf::Vector2f> before;
+    std::vector<uint32_t> versions;
+    for (size_t i = 0; i < points.size(); ++i) {
+        before = incremental.positions();
+        versions.resize(before.size());
+        for (size_t u = 0; u < before.size(); ++u) {
+            versions[u] = incremental.version(static_cast<int>(u));
+        }
+        incremental.insert(points[i]);
+        for (size_t u = 0; u < before.size(); ++u) {
+            const int node = static_cast<int>(u);
+            if (incremental.alive(node) && incremental.version(node) == versions[u]) {
+                expect(incremental.positions()[u] == before[u], "insert moved kept node " + std::to_string(u));
+            }
+        }
+        if ((i + 1) % 64 == 0 || i + 1 == points.size()) {
+            incremental.compact(graph);
+            checkGraph(graph, incremental.sites(), "incremental " + std::to_string(i + 1) + " sites");
+        }
+    }
+
+    NavGraph boost;
+    sf::VertexArray lines(sf::Lines);
+    buildVoronoiGraph(points, boost, lines);
+    expect(liveNodes(graph) == boost.size(), "incremental and boost node counts");
+    expect(graph.targets.size() == boost.targets.size(), "incremental and boost edge counts");
+
+    // Integer sites: duplicates, collinear runs and cocircular quadruples
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<int> x(0, 40), y(0, 20);
+    IncrementalVoronoi degenerate;
+    for (int i = 0; i < 4; ++i) {
+        degenerate.insert(sf::Vector2f(10.f * i, 100.f));
+    }
+    for (int i = 0; i < count / 2; ++i) {
+        const sf::Vector2f site(x(gen) * 40.f, y(gen) * 40.f);
+        const bool known = std::find(degenerate.sites().begin(), degenerate.sites().end(), site) != degenerate.sites().end();
+        expect(degenerate.insert(site) != known, "insert of a known site");
+    }
+    degenerate.compact(graph);
+    checkGraph(graph, degenerate.sites(), "degenerate");
+    std::cout << "IncrementalVoronoi: " << count << " random sites, " << degenerate.sites().size()
+              << " grid sites" << std::endl;
+}
+
+// SafestPath against a widest path Dijkstra, and its routes against a
+// Dijkstra restricted to the edges of at least the bottleneck
+void checkSafest(const NavGraph& graph) {
+    SafestPath safest;
+    safest.build(graph);
+    SearchContext search;
+    std::mt19937 gen(SEED + 1);
+    std::uniform_int_distribution<int> node(0, static_cast<int>(graph.size()) - 1);
+    std::vector<int> route;
+
+    for (int s = 0; s < QUERIES / 10; ++s) {
+        const int from = node(gen);
+        const std::vector<float> widths = widest(graph, from);
+        for (int t = 0; t < 10; ++t) {
+            const int to = node(gen);
+            const std::string query = std::to_string(from) + " -> " + std::to_string(to);
+            const float bottleneck = safest.bottleneck(from, to);
+            expect(bottleneck == widths[to], "bottleneck " + query);
+
+            route.clear();
+            safest.treePath(from, to, route);
+            if (from != to && widths[to] > 0.f) {
+                expect(routeClearance(graph, route, from, to, 0.f) == bottleneck, "treePath " + query);
+            } else {
+                expect(route.size() == (from == to ? 1u : 0u), "treePath without route " + query);
+            }
+
+            const bool found = safest.path(graph, search, from, to, route);
+            expect(found == (widths[to] > 0.f), "path found " + query);
+            if (found && from != to) {
+                expect(routeClearance(graph, route, from, to, 0.f) == bottleneck, "path clearance " + query);
+                expect(close(routeLength(graph, route), shortest(graph, from, bottleneck)[to]), "path length " + query);
+            }
+        }
+    }
+    std::cout << "SafestPath: " << QUERIES << " queries on " << graph.size() << " nodes" << std::endl;
+}
+
+// SearchContext and PathService against a plain Dijkstra, one context for
+// every query so that stale generations are exercised
+void checkSearch(const NavGraph& graph) {
+    std::vector<float> sorted(graph.clearances);
+    std::sort(sorted.begin(), sorted.end());
+    std::mt19937 gen(SEED + 2);
+    std::uniform_int_distribution<int> node(0, static_cast<int>(graph.size()) - 1);
+    std::uniform_int_distribution<size_t> quantile(0, sorted.size() - 1);
+    auto minClearance = [&]() { return gen() % 3 == 0 ? 0.f : sorted[quantile(gen) / 2]; };
+
+    SearchContext search;
+    std::vector<int> route;
+    for (int q = 0; q < QUERIES; ++q) {
+        const int from = node(gen), to = node(gen);
+        const float least = minClearance();
+        const std::string query = std::to_string(from) + " -> " + std::to_string(to) + " above " + std::to_string(least);
+        const float expected = shortest(graph, from, least)[to];
+        const bool found = search.aStar(graph, from, to, least, route);
+        expect(found == (expected < INFINITE), "aStar found " + query);
+        if (found) {
+            expect(routeClearance(graph, route, from, to, least) >= 0.f, "aStar route " + query);
+            expect(close(routeLength(graph, route), expected), "aStar length " + query);
+        } else {
+            expect(route.empty(), "aStar without route " + query);
+        }
+
+        // The same start to several goals at once
+        int goals[8];
+        for (int& goal : goals) {
+            goal = node(gen);
+        }
+        search.dijkstra(graph, from, goals, 8, least);
+        const std::vector<float> lengths = shortest(graph, from, least);
+        for (int goal : goals) {
+            route.clear();
+            const float length = search.pathTo(goal, route);
+            expect(close(length, lengths[goal]), "dijkstra length " + std::to_string(from) + " -> " + std::to_string(goal));
+            if (length < INFINITE) {
+                expect(routeClearance(graph, route, from, goal, least) >= 0.f, "dijkstra route " + std::to_string(goal));
+            }
+        }
+    }
+
+    ThreadPool pool(2);
+    PathService service(pool);
+    std::vector<std::pair<int, int>> requests(QUERIES);
+    std::vector<int> sources(8);
+    for (int& source : sources) {
+        source = node(gen);
+    }
+    for (auto& request : requests) {
+        request = std::make_pair(sources[gen() % sources.size()], node(gen));
+    }
+    const float least = minClearance();
+    PathBatch batch;
+    service.solve(graph, requests, least, batch);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const float expected = shortest(graph, requests[i].first, least)[requests[i].second];
+        expect(close(batch.lengths[i], expected), "PathService length of request " + std::to_string(i));
+        if (expected < INFINITE) {
+            const std::vector<int> nodes(batch.nodes.begin() + batch.offsets[i], batch.nodes.begin() + batch.offsets[i + 1]);
+            expect(routeClearance(graph, nodes, requests[i].first, requests[i].second, least) >= 0.f,
+                   "PathService route of request " + std::to_string(i));
+        }
+    }
+    std::cout << "SearchContext, PathService: " << QUERIES << " queries on " << graph.size() << " nodes" << std::endl;
+}
+
+}
+
+int main(int argc, char const* argv[]) {
+    const int sites = (argc > 1) ? std::atoi(argv[1]) : 1000;
+
+    checkIncremental(sites);
+
+    NavGraph graph;
+    sf::VertexArray lines(sf::Lines);
+    buildVoronoiGraph(randomPoints(sites, SEED, WIDTH, HEIGHT), graph, lines);
+    checkSafest(graph);
+    checkSearch(graph);
+
+    // With dead nodes, as the app searches it
+    IncrementalVoronoi incremental;
+    for (const auto& site : randomPoints(sites, SEED + 3, WIDTH, HEIGHT)) {
+        incremental.insert(site);
+    }
+    incremental.compact(graph);
+    checkSafest(graph);
+    checkSearch(graph);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,7 @@
 #include "voronoi.hpp"
+#include "incremental_voronoi.hpp"
+#include "safest_path.hpp"
+#include "search_context.hpp"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
@@ -7,8 +10,9 @@
 Voronoi::Voronoi(int width, int height, int initialPoints)
     : WIDTH(width), HEIGHT(height), pointsNumber(initialPoints),
       window(sf::VideoMode(width, height), "Voronoi Diagram", sf::Style::Close | sf::Style::Titlebar, sf::ContextSettings(0, 0, 8)),
-      gen(dev()), wRand(30.0, width - 30.0), hRand(30.0, height - 30.0), edges(sf::Lines) {
+      gen(dev()), wRand(30.0, width - 30.0), hRand(30.0, height - 30.0) {
 
+    window.setFramerateLimit(60);
     window.setPosition(sf::Vector2i(0, 0));
     coordinates.resize(pointsNumber);
     std::generate(coordinates.begin(), coordinates.end(), [&]() { return sf::Vector2f(wRand(gen), hRand(gen)); });
@@ -24,12 +28,18 @@ Voronoi::Voronoi(int width, int height, int initialPoints)
     tempPoint.setOrigin(4, 4);
     tempPoint.setOutlineColor(sf::Color::Green);
 
+    graph.reset(new IncrementalVoronoi());
+    safest.reset(new SafestPath());
+    search.reset(new SearchContext());
     for (auto& coord : coordinates) {
         tempPoint.setPosition(coord);
         circles.push_back({tempPoint, false});
+        graph->insert(coord);
     }
 }
 
+Voronoi::~Voronoi() {}
+
 bool Voronoi::initialize() {
     if (!sf::Shader::isAvailable()) {
         std::cerr << "Shaders are not available on this PC!" << std::endl;
@@ -48,7 +58,10 @@ bool Voronoi::initialize() {
         return false;
     }
 
-    generateVoronoi();
+    if (!diagram.create(WIDTH, HEIGHT)) {
+        std::cerr << "Failed to create the diagram texture!" << std::endl;
+        return false;
+    }
 
     return true;
 }
@@ -62,6 +75,18 @@ void Voronoi::run() {
 }
 
 void Voronoi::addPoint(sf::Vector2f position) {
+    // Only the nodes around the new site change; a path end on one of them is
+    // lost, even when the insert reused its id for a new node
+    if (!graph->insert(position)) {
+        return;
+    }
+    if (startNode != -1 && (!graph->alive(startNode) || graph->version(startNode) != startVersion)) {
+        startNode = -1;
+    }
+    if (endNode != -1 && (!graph->alive(endNode) || graph->version(endNode) != endVersion)) {
+        endNode = -1;
+    }
+
     coordinates.push_back(position);
     sf::CircleShape tempPoint(4, 100);
     tempPoint.setFillColor(sf::Color::Black);
@@ -75,7 +100,17 @@ void Voronoi::addPoint(sf::Vector2f position) {
 #endif
 
     pointsNumber++;
-    generateVoronoi(); 
+    diagramDirty = true;
+    navigationDirty = true;
+}
+
+const NavGraph& Voronoi::navigationGraph() {
+    if (navigationDirty) {
+        graph->compact(navigation);
+        safest->build(navigation);
+        navigationDirty = false;
+    }
+    return navigation;
 }
 
 void Voronoi::handleEvents() {
@@ -95,29 +130,40 @@ void Voronoi::handleEvents() {
             float minDistance = std::numeric_limits<float>::infinity();
             int closestNode = -1;
 
-            for (size_t i = 0; i < graphNodes.size(); ++i) {
-                float distance = sqrt(pow(graphNodes[i].position.x - mousePos.x, 2) +
-                                      pow(graphNodes[i].position.y - mousePos.y, 2));
+            const std::vector<sf::Vector2f>& positions = graph->positions();
+            for (size_t i = 0; i < positions.size(); ++i) {
+                if (!graph->alive(static_cast<int>(i))) {
+                    continue;
+                }
+                float distance = sqrt(pow(positions[i].x - mousePos.x, 2) +
+                                      pow(positions[i].y - mousePos.y, 2));
                 if (distance < minDistance) {
                     minDistance = distance;
                     closestNode = static_cast<int>(i);
                 }
             }
 
+            const uint32_t version = (closestNode != -1) ? graph->version(closestNode) : 0;
             if (selectingStartNode) {
                 startNode = closestNode;
+                startVersion = version;
                 selectingStartNode = false;
                 std::cout << "Start node selected: " << startNode << std::endl;
             } else {
                 endNode = closestNode;
+                endVersion = version;
                 selectingStartNode = true;
                 std::cout << "End node selected: " << endNode << std::endl;
             }
         }
 
         if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::A) {
-            if (graphNodes.size() > 1 && startNode != -1 && endNode != -1) {
-                std::vector<int> path = aStar(startNode, endNode);
+            if (graph->positions().size() > 1 && startNode != -1 && endNode != -1) {
+                std::vector<int> path;
+                if (!safest->path(navigationGraph(), *search, startNode, endNode, path)) {
+                    std::cerr << "No path found!" << std::endl;
+                }
+                std::cout << "Clearance: " << safest->bottleneck(startNode, endNode) << std::endl;
 
                 // Debugging: Print the path
                 std::cout << "Path: ";
@@ -138,11 +184,28 @@ void Voronoi::update() {
 }
 
 void Voronoi::render() {
+    if (diagramDirty) {
+        renderDiagram();
+    }
+
     window.clear(sf::Color::White);
+    window.draw(sf::Sprite(diagram.getTexture()));
+
+    window.draw(graph->lines());
+    
+    for (auto& c : circles) {
+        window.draw(c.first);
+    }
+
+    window.display();
+}
+
+void Voronoi::renderDiagram() {
+    diagram.clear(sf::Color::White);
 
     std::vector<sf::Vector2f> copy(coordinates.size());
     std::transform(coordinates.begin(), coordinates.end(), copy.begin(), [&](sf::Vector2f vec) {
-        return sf::Vector2f(vec.x, window.getSize().y - vec.y);
+        return sf::Vector2f(vec.x, diagram.getSize().y - vec.y);
     });
 
     shader.setUniform("size", pointsNumber);
@@ -152,152 +215,82 @@ void Voronoi::render() {
     shader.setUniformArray("colors", colors.data(), MAX_POINTS_NUMBER);
 #endif
 
-    window.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
-
-    window.draw(edges);
-    
-    for (auto& c : circles) {
-        window.draw(c.first);
-    }
-
-    window.display();
+    diagram.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
+    diagram.display();
+    diagramDirty = false;
 }
 
-void Voronoi::generateVoronoi() {
+void buildVoronoiGraph(const std::vector<sf::Vector2f>& sites, NavGraph& graph, sf::VertexArray& edges) {
     edges.clear();
-    graphNodes.clear();
+    graph.clear();
 
     std::vector<point_data<float>> inputPoints;
-    for (const auto& point : coordinates) {
+    for (const auto& point : sites) {
         inputPoints.emplace_back(point.x, point.y);
     }
 
     voronoi_diagram<double> vd;
     construct_voronoi(inputPoints.begin(), inputPoints.end(), &vd);
-
-    std::unordered_map<const voronoi_diagram<double>::vertex_type*, int> vertexIndexMap;
-    int vertexCount = 0;
-
-    for (auto it = vd.vertices().begin(); it != vd.vertices().end(); ++it) {
-        const voronoi_diagram<double>::vertex_type& vertex = *it;
-        float vx = vertex.x();
-        float vy = vertex.y(); 
-        graphNodes.emplace_back(sf::Vector2f(vx, vy));
-        vertexIndexMap[&vertex] = vertexCount++;
+    if (vd.vertices().empty()) {
+        return;
     }
 
-    for (auto it = vd.cells().begin(); it != vd.cells().end(); ++it) {
-        const voronoi_diagram<double>::cell_type& cell = *it;
-        const voronoi_diagram<double>::edge_type* edge = cell.incident_edge();
-        int site_index = cell.source_index();
-
-        do {
-            if (edge->is_primary()) {
-                const voronoi_diagram<double>::vertex_type* v0 = edge->vertex0();
-                const voronoi_diagram<double>::vertex_type* v1 = edge->vertex1();
-                if (v0 && v1) {
-                    int idx0 = vertexIndexMap[v0];
-                    int idx1 = vertexIndexMap[v1];
-
-                    // Compute distance from edge midpoint to Voronoi site (generator point)
-                    float site_x = inputPoints[site_index].x();
-                    float site_y = inputPoints[site_index].y();
-                    float midpoint_x = (v0->x() + v1->x()) / 2.0;
-                    float midpoint_y = (v0->y() + v1->y()) / 2.0;
-                    float distance_to_site = sqrt(pow(midpoint_x - site_x, 2) + pow(midpoint_y - site_y, 2));
-
-                    // Use distance to site as weight (store negative for max-heap behavior)
-                    graphNodes[idx0].neighbors.emplace_back(idx1, -distance_to_site);
-                    graphNodes[idx1].neighbors.emplace_back(idx0, -distance_to_site);
-
-                    float v0_x = v0->x();
-                    float v0_y = v0->y(); // Flip y-coordinate
-                    float v1_x = v1->x();
-                    float v1_y = v1->y(); // Flip y-coordinate
-                    edges.append(sf::Vertex(sf::Vector2f(v0_x, v0_y), sf::Color::Red));
-                    edges.append(sf::Vertex(sf::Vector2f(v1_x, v1_y), sf::Color::Red));
-                }
-            }
-            edge = edge->next();
-        } while (edge != cell.incident_edge());
+    // Node i is vd.vertices()[i]: its index is its offset in the vector
+    const voronoi_diagram<double>::vertex_type* firstVertex = &vd.vertices().front();
+    for (const auto& vertex : vd.vertices()) {
+        graph.positions.emplace_back(vertex.x(), vertex.y());
     }
-}
-
 
-
-std::vector<int> Voronoi::aStar(int startNode, int endNode) {
-    std::cout << "Starting A* from node " << startNode << " to node " << endNode << std::endl;
-
-    std::vector<float> gScore(graphNodes.size(), std::numeric_limits<float>::infinity());
-    std::vector<float> fScore(graphNodes.size(), std::numeric_limits<float>::infinity());
-    std::vector<int> cameFrom(graphNodes.size(), -1);
-
-    auto heuristic = [&](int node) {
-        return sqrt(pow(graphNodes[node].position.x - graphNodes[endNode].position.x, 2) + 
-                    pow(graphNodes[node].position.y - graphNodes[endNode].position.y, 2));
+    // Each edge once, from the first of its two halves; the other half borders the other site
+    auto kept = [](const voronoi_diagram<double>::edge_type& edge) {
+        return edge.is_primary() && edge.is_finite() && &edge < edge.twin();
     };
 
-    gScore[startNode] = 0.0f;
-    fScore[startNode] = heuristic(startNode);
-
-    using PQElement = std::pair<float, int>;
-    std::priority_queue<PQElement, std::vector<PQElement>, std::greater<PQElement>> openSet;
-    openSet.emplace(fScore[startNode], startNode);
-
-    std::unordered_set<int> openSetHash;
-    openSetHash.insert(startNode);
-
-    std::unordered_set<int> closedSet;
-
-    while (!openSet.empty()) {
-        int current = openSet.top().second;
-        openSet.pop();
-
-        if (closedSet.find(current) != closedSet.end()) {
-            continue; // Skip this node if it has already been processed
-        }
-        
-        closedSet.insert(current);
-
-        std::cout << "Processing node " << current << std::endl;
-
-        if (current == endNode) {
-            std::vector<int> path;
-            for (int at = endNode; at != -1; at = cameFrom[at]) {
-                path.push_back(at);
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
+    // Counting sort of the edges by node: degrees, then their prefix sums
+    graph.offsets.assign(graph.positions.size() + 1, 0);
+    for (const auto& edge : vd.edges()) {
+        if (kept(edge)) {
+            graph.offsets[edge.vertex0() - firstVertex + 1]++;
+            graph.offsets[edge.vertex1() - firstVertex + 1]++;
         }
+    }
+    for (size_t i = 1; i < graph.offsets.size(); ++i) {
+        graph.offsets[i] += graph.offsets[i - 1];
+    }
+    graph.targets.resize(graph.offsets.back());
+    graph.clearances.resize(graph.offsets.back());
 
-        for (auto& [neighbor, weight] : graphNodes[current].neighbors) {
-            if (closedSet.find(neighbor) != closedSet.end()) {
-                continue; // Skip neighbors that have already been processed
-            }
-
-            float tentative_gScore = gScore[current] + weight;
-            if (tentative_gScore < gScore[neighbor]) {
-                cameFrom[neighbor] = current;
-                gScore[neighbor] = tentative_gScore;
-                fScore[neighbor] = gScore[neighbor] + heuristic(neighbor);
-
-                if (openSetHash.find(neighbor) == openSetHash.end()) {
-                    openSet.emplace(fScore[neighbor], neighbor);
-                    openSetHash.insert(neighbor);
-                }
-            }
+    for (const auto& edge : vd.edges()) {
+        if (!kept(edge)) {
+            continue;
         }
+        const int idx0 = static_cast<int>(edge.vertex0() - firstVertex);
+        const int idx1 = static_cast<int>(edge.vertex1() - firstVertex);
+
+        // Clearance from the Voronoi site (generator point) of the cell;
+        // offsets[i] is the next free slot of node i until the shift below
+        const sf::Vector2f site(inputPoints[edge.cell()->source_index()].x(),
+                                inputPoints[edge.cell()->source_index()].y());
+        const float edgeClearance = clearance(graph.positions[idx0], graph.positions[idx1], site);
+        graph.targets[graph.offsets[idx0]] = idx1;
+        graph.clearances[graph.offsets[idx0]++] = edgeClearance;
+        graph.targets[graph.offsets[idx1]] = idx0;
+        graph.clearances[graph.offsets[idx1]++] = edgeClearance;
+
+        edges.append(sf::Vertex(graph.positions[idx0], sf::Color::Red));
+        edges.append(sf::Vertex(graph.positions[idx1], sf::Color::Red));
     }
-
-    std::cerr << "No path found!" << std::endl;
-    return {}; // Return empty path if no path found
+    for (size_t i = graph.offsets.size() - 1; i > 0; --i) {
+        graph.offsets[i] = graph.offsets[i - 1];
+    }
+    graph.offsets[0] = 0;
 }
 
 
 
-
 void Voronoi::displayPath(const std::vector<int>& path) {
     sf::RenderWindow pathWindow(sf::VideoMode(WIDTH, HEIGHT), "A* Path", sf::Style::Close | sf::Style::Titlebar);
+    pathWindow.setFramerateLimit(60);
     pathWindow.setPosition(sf::Vector2i(0, 0));
     while (pathWindow.isOpen()) {
         sf::Event event;
@@ -309,19 +302,10 @@ void Voronoi::displayPath(const std::vector<int>& path) {
 
         pathWindow.clear(sf::Color::White);
 
-        std::vector<sf::Vector2f> copy(coordinates.size());
-        std::transform(coordinates.begin(), coordinates.end(), copy.begin(), [&](sf::Vector2f vec) {
-            return sf::Vector2f(vec.x, pathWindow.getSize().y - vec.y);
-        });
-
-        shader.setUniform("size", pointsNumber);
-        shader.setUniformArray("seeds", copy.data(), MAX_POINTS_NUMBER);
-
-    #ifdef COLORS
-        shader.setUniformArray("colors", colors.data(), MAX_POINTS_NUMBER);
-    #endif
-
-        pathWindow.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
+        if (diagramDirty) {
+            renderDiagram();
+        }
+        pathWindow.draw(sf::Sprite(diagram.getTexture()));
 
 
         // Draw points
@@ -334,8 +318,8 @@ void Voronoi::displayPath(const std::vector<int>& path) {
         // Draw the path
         for (size_t i = 1; i < path.size(); ++i) {
             sf::Vertex line[] = {
-                sf::Vertex(graphNodes[path[i-1]].position, sf::Color::Red),
-                sf::Vertex(graphNodes[path[i]].position, sf::Color::Red)
+                sf::Vertex(navigation.positions[path[i-1]], sf::Color::Red),
+                sf::Vertex(navigation.positions[path[i]], sf::Color::Red)
             };
             pathWindow.draw(line, 10, sf::Lines);
         }
@@ -345,13 +329,13 @@ void Voronoi::displayPath(const std::vector<int>& path) {
             sf::CircleShape startCircle(5);
             startCircle.setFillColor(sf::Color::Blue);
             startCircle.setOrigin(5, 5);
-            startCircle.setPosition(graphNodes[path.front()].position);
+            startCircle.setPosition(navigation.positions[path.front()]);
             pathWindow.draw(startCircle);
 
             sf::CircleShape endCircle(5);
             endCircle.setFillColor(sf::Color::Red);
             endCircle.setOrigin(5, 5);
-            endCircle.setPosition(graphNodes[path.back()].position);
+            endCircle.setPosition(navigation.positions[path.back()]);
             pathWindow.draw(endCircle);
         }
 
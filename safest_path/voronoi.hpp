@@ -9,6 +9,8 @@
 #include <unordered_set>
 #include <queue>
 #include <functional>
+#include <memory>
+#include "nav_graph.hpp"
 
 using namespace boost::polygon;
 using namespace std;
@@ -36,16 +38,20 @@ struct VoronoiRegion {
     VoronoiRegion(int pointIndex) : pointIndex(pointIndex) {}
 };
 
-struct GraphNode {
-    sf::Vector2f position;
-    std::vector<std::pair<int, float>> neighbors; // Pair of neighbor index and distance
+// Graph of the Voronoi vertices of `sites`: primary edges with their clearance,
+// also appended to `lines` for drawing.
+// Node i is the i-th vertex of the boost diagram. Rebuilt from scratch; the app
+// patches an IncrementalVoronoi instead
+void buildVoronoiGraph(const std::vector<sf::Vector2f>& sites, NavGraph& graph, sf::VertexArray& lines);
 
-    GraphNode(sf::Vector2f pos) : position(pos) {}
-};
+class IncrementalVoronoi;
+class SafestPath;
+class SearchContext;
 
 class Voronoi {
 public:
     Voronoi(int width, int height, int initialPoints);
+    ~Voronoi();
     bool initialize();
     void run();
 
@@ -56,12 +62,17 @@ private:
     int pointsNumber;
     int startNode = -1;
     int endNode = -1;
+    uint32_t startVersion = 0; // of the node when selected
+    uint32_t endVersion = 0;
     bool selectingStartNode = true;
     sf::RenderWindow window;
     std::vector<sf::Vector2f> coordinates;
     std::vector<std::pair<sf::CircleShape, bool>> circles; 
     sf::Shader shader;
-    sf::VertexArray edges;
+    // Shader output, only recomputed when the sites change; edges, sites and
+    // paths are drawn on top of it
+    sf::RenderTexture diagram;
+    bool diagramDirty = true;
     std::random_device dev;
     std::mt19937 gen;
     std::uniform_real_distribution<> wRand;
@@ -71,15 +82,22 @@ private:
     std::vector<sf::Vector3f> colors;
 #endif
 
-    std::vector<GraphNode> graphNodes; // For A* pathfinding
+    // Graph for A* pathfinding, patched around each new site; its edges are drawn
+    std::unique_ptr<IncrementalVoronoi> graph;
+    // Compact copy of `graph` for the searches, same node ids, and its
+    // safest routes, both redone after a change
+    NavGraph navigation;
+    std::unique_ptr<SafestPath> safest;
+    std::unique_ptr<SearchContext> search;
+    bool navigationDirty = true;
 
     void handleEvents();
     void update();
     void render();
-    void generateVoronoi();
+    void renderDiagram();
+    const NavGraph& navigationGraph();
     void displayPath(const std::vector<int>& path);
     void addPoint(sf::Vector2f position);
-    std::vector<int> aStar(int startNode, int endNode);
 };
 
 #endif // VORONOI_HPP
@@ -0,0 +1,57 @@
+#include "agents.hpp"
+#include "minimax.hpp"
+#include "mcts.hpp"
+#include <limits>
+#include <memory>
+#include <random>
+
+GameEngine::Agent randomAgent(unsigned seed) {
+    auto gen = std::make_shared<std::mt19937>(seed);
+    return [gen](GameEngine& engine) {
+        std::uniform_real_distribution<float> x(0.0f, engine.width());
+        std::uniform_real_distribution<float> y(0.0f, engine.height());
+        return sf::Vector2f(x(*gen), y(*gen));
+    };
+}
+
+GameEngine::Agent greedyAgent(int columns, int rows) {
+    return [columns, rows](GameEngine& engine) {
+        sf::Vector2f best(engine.width() / 2, engine.height() / 2);
+        double bestGain = -std::numeric_limits<double>::infinity();
+
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < columns; ++c) {
+                sf::Vector2f candidate((c + 0.5f) * engine.width() / columns, (r + 0.5f) * engine.height() / rows);
+                double gain = engine.gain(candidate);
+                if (gain > bestGain) {
+                    bestGain = gain;
+                    best = candidate;
+                }
+            }
+        }
+        return best;
+    };
+}
+
+GameEngine::Agent minimaxAgent(int timeBudgetMs) {
+    std::shared_ptr<MinimaxAI> ai;
+    return [ai, timeBudgetMs](GameEngine& engine) mutable {
+        if (!ai) {
+            ai = std::make_shared<MinimaxAI>(engine.width(), engine.height(), timeBudgetMs);
+        }
+        return ai->chooseMove(engine.sites(), engine.owners(), engine.currentPlayer(), engine.turnsLeft()).move;
+    };
+}
+
+GameEngine::Agent mctsAgent(int timeBudgetMs, unsigned threads) {
+    std::shared_ptr<MctsAI> ai;
+    return [ai, timeBudgetMs, threads](GameEngine& engine) mutable {
+        if (!ai) {
+            MctsConfig config;
+            config.timeBudgetMs = timeBudgetMs;
+            config.threads = threads;
+            ai = std::make_shared<MctsAI>(config);
+        }
+        return ai->chooseMove(engine).move;
+    };
+}
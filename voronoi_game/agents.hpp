@@ -0,0 +1,18 @@
+#ifndef AGENTS_HPP
+#define AGENTS_HPP
+
+#include "engine.hpp"
+
+// Uniformly random placement on the board
+GameEngine::Agent randomAgent(unsigned seed);
+
+// Best immediate territory gain over a columns x rows grid of candidates
+GameEngine::Agent greedyAgent(int columns = 8, int rows = 5);
+
+// Alpha-beta search with the given time budget per move
+GameEngine::Agent minimaxAgent(int timeBudgetMs);
+
+// Parallel Monte Carlo tree search on `threads` workers
+GameEngine::Agent mctsAgent(int timeBudgetMs, unsigned threads);
+
+#endif // AGENTS_HPP
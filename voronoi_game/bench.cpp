@@ -0,0 +1,81 @@
+// Benchmarks of the territory scoring, one JSON document on stdout to diff between commits.
+// Usage: ./bench [maxSites]
+#include "territory.hpp"
+#include "incremental_territory.hpp"
+#include "rasterizer.hpp"
+#include "jump_flooding.hpp"
+#include "thread_pool.hpp"
+#include "benchmark.hpp"
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1200;
+const int HEIGHT = 800;
+const unsigned SEED = 12345;
+const int PLAYERS = 2;
+const int QUERIES = 1000;
+// pixelTerritoryAreas is O(W * H * n): above this many distance tests it is skipped
+const double MAX_PIXEL_TESTS = 1e8;
+const int SIZES[] = {10, 100, 1000, 10000, 100000};
+
+}
+
+int main(int argc, char const* argv[]) {
+    const int maxSites = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    const std::vector<sf::Vector2f> queries = randomPoints(QUERIES, SEED - 1, WIDTH, HEIGHT);
+    ThreadPool pool;
+    OwnershipRasterizer rasterizer(WIDTH, HEIGHT, pool);
+    JumpFlooding flood(WIDTH, HEIGHT, pool);
+    IncrementalTerritory territory(WIDTH, HEIGHT, PLAYERS);
+
+    beginReport();
+    for (int sites : SIZES) {
+        if (sites > maxSites) {
+            break;
+        }
+        const std::vector<sf::Vector2f> points = randomPoints(sites, SEED + sites, WIDTH, HEIGHT);
+        std::vector<int> owners(sites);
+        for (int i = 0; i < sites; ++i) {
+            owners[i] = i % PLAYERS;
+        }
+
+        // What Voronoi::calculateAreas computes, exactly and by the old pixel loop
+        measure("territoryAreas", sites, 1, [&]() {
+            sink = sink + territoryAreas(points, owners, PLAYERS, WIDTH, HEIGHT)[0];
+        });
+        if (static_cast<double>(WIDTH) * HEIGHT * sites <= MAX_PIXEL_TESTS) {
+            measure("pixelTerritoryAreas", sites, 1, [&]() {
+                sink = sink + pixelTerritoryAreas(points, owners, PLAYERS, WIDTH, HEIGHT)[0];
+            });
+        } else {
+            skip("pixelTerritoryAreas", sites);
+        }
+
+        measure("OwnershipRasterizer::rasterize", sites, 1, [&]() {
+            rasterizer.rasterize(points, owners, PLAYERS);
+            sink = sink + rasterizer.playerCounts()[0];
+        });
+        measure("JumpFlooding::flood", sites, 1, [&]() {
+            flood.flood(points, owners, PLAYERS);
+            sink = sink + flood.playerCounts()[0];
+        });
+
+        territory.assign(points, owners);
+        measure("IncrementalTerritory::insert+undo", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                territory.insert(query, 0);
+                territory.undo();
+            }
+        });
+        measure("IncrementalTerritory::gain", sites, QUERIES, [&]() {
+            for (const auto& query : queries) {
+                sink = sink + territory.gain(query, 0);
+            }
+        });
+    }
+    endReport();
+
+    return EXIT_SUCCESS;
+}
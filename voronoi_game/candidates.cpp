@@ -0,0 +1,206 @@
+#include "candidates.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CandidateGenerator::CandidateGenerator(int gridColumns, int gridRows)
+    : GRID_COLUMNS(gridColumns), GRID_ROWS(gridRows), proposed(0), evaluated(0) {}
+
+void CandidateGenerator::add(const IncrementalTerritory& territory, sf::Vector2f position,
+                             std::vector<Candidate>& out) const {
+    position.x = std::min(std::max(position.x, 0.0f), territory.width());
+    position.y = std::min(std::max(position.y, 0.0f), territory.height());
+    out.push_back({position, 0.0, 0.0});
+}
+
+void CandidateGenerator::propose(const IncrementalTerritory& territory, int player, std::vector<Candidate>& out) {
+    out.clear();
+    opponents.clear();
+
+    for (size_t i = 0; i < territory.size(); ++i) {
+        const IncrementalTerritory::Cell& cell = territory.cell(static_cast<int>(i));
+        if (cell.vertices.empty()) {
+            continue;
+        }
+        const sf::Vector2f& site = territory.sites()[i];
+        const bool opponent = territory.owners()[i] != player;
+
+        double cx = 0.0;
+        double cy = 0.0;
+        double twiceArea = 0.0;
+        double radius = 0.0;
+        for (size_t v = 0; v < cell.vertices.size(); ++v) {
+            const sf::Vector2<double>& p = cell.vertices[v];
+            const sf::Vector2<double>& q = cell.vertices[(v + 1) % cell.vertices.size()];
+            double cross = p.x * q.y - q.x * p.y;
+            cx += (p.x + q.x) * cross;
+            cy += (p.y + q.y) * cross;
+            twiceArea += cross;
+            radius = std::max(radius, std::hypot(p.x - site.x, p.y - site.y));
+
+            // Voronoi vertices, each one shared by up to three cells
+            add(territory, sf::Vector2f(p.x, p.y), out);
+            if (opponent) {
+                add(territory, sf::Vector2f((p.x + q.x) / 2, (p.y + q.y) / 2), out);
+            }
+        }
+
+        if (twiceArea != 0.0) {
+            add(territory, sf::Vector2f(cx / (3.0 * twiceArea), cy / (3.0 * twiceArea)), out);
+        }
+        if (opponent) {
+            opponents.push_back({double(site.x), double(site.y), radius, cell.area, static_cast<int>(i)});
+        }
+    }
+
+    for (int r = 0; r < GRID_ROWS; ++r) {
+        for (int c = 0; c < GRID_COLUMNS; ++c) {
+            add(territory, sf::Vector2f((c + 0.5f) * territory.width() / GRID_COLUMNS,
+                                        (r + 0.5f) * territory.height() / GRID_ROWS), out);
+        }
+    }
+
+    // Drop the duplicates, mostly vertices shared between cells
+    std::sort(out.begin(), out.end(), [](const Candidate& a, const Candidate& b) {
+        return a.position.x < b.position.x || (a.position.x == b.position.x && a.position.y < b.position.y);
+    });
+    out.erase(std::unique(out.begin(), out.end(), [](const Candidate& a, const Candidate& b) {
+        return a.position == b.position;
+    }), out.end());
+
+    // Right on top of a site a move takes nothing
+    const double board = double(territory.width()) * territory.height();
+    size_t kept = 0;
+    for (size_t i = 0; i < out.size(); ++i) {
+        Candidate& candidate = out[i];
+        int nearest = territory.nearestSite(candidate.position);
+        if (nearest >= 0) {
+            const sf::Vector2f& site = territory.sites()[nearest];
+            float dx = site.x - candidate.position.x;
+            float dy = site.y - candidate.position.y;
+            if (dx * dx + dy * dy < MIN_SPACING * MIN_SPACING) {
+                continue;
+            }
+        }
+        candidate.bound = territory.size() == 0 ? board : coarseBound(candidate.position);
+        out[kept++] = candidate;
+    }
+    out.resize(kept);
+}
+
+double CandidateGenerator::coarseBound(sf::Vector2f position) const {
+    double total = 0.0;
+    for (const Opponent& o : opponents) {
+        const double dx = position.x - o.x;
+        const double dy = position.y - o.y;
+        const double d2 = dx * dx + dy * dy;
+        if (d2 > 0.0 && d2 < 4.0 * o.radius * o.radius) {
+            total += o.area;
+        }
+    }
+    return total;
+}
+
+double CandidateGenerator::refinedBound(const IncrementalTerritory& territory, sf::Vector2f position) const {
+    double total = 0.0;
+    for (const Opponent& o : opponents) {
+        const double dx = position.x - o.x;
+        const double dy = position.y - o.y;
+        const double d = std::sqrt(dx * dx + dy * dy);
+        const double a = d / 2; // distance from the site to the bisector
+        if (a >= o.radius || d == 0.0) {
+            continue; // out of reach, or same spot where the older site wins
+        }
+
+        // The part taken is the cell clipped to the far side of the bisector:
+        // its area by the shoelace formula over the clipped outline, in a frame
+        // turned along q - s_c
+        const double ux = dx / d;
+        const double uy = dy / d;
+        const std::vector<sf::Vector2<double>>& vertices = territory.cell(o.site).vertices;
+        double twiceArea = 0.0;
+        double firstAlong = 0.0, firstAcross = 0.0;
+        double lastAlong = 0.0, lastAcross = 0.0;
+        bool started = false;
+        auto emit = [&](double along, double across) {
+            if (started) {
+                twiceArea += lastAlong * across - along * lastAcross;
+            } else {
+                firstAlong = along;
+                firstAcross = across;
+                started = true;
+            }
+            lastAlong = along;
+            lastAcross = across;
+        };
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const sf::Vector2<double>& p = vertices[i];
+            const sf::Vector2<double>& q = vertices[(i + 1) % vertices.size()];
+            const double pAlong = (p.x - o.x) * ux + (p.y - o.y) * uy - a;
+            const double qAlong = (q.x - o.x) * ux + (q.y - o.y) * uy - a;
+            const double pAcross = (p.y - o.y) * ux - (p.x - o.x) * uy;
+            if (pAlong > 0.0) {
+                emit(pAlong, pAcross);
+            }
+            if ((pAlong > 0.0) != (qAlong > 0.0)) {
+                const double qAcross = (q.y - o.y) * ux - (q.x - o.x) * uy;
+                emit(0.0, pAcross + pAlong / (pAlong - qAlong) * (qAcross - pAcross));
+            }
+        }
+        if (!started) {
+            continue;
+        }
+        twiceArea += lastAlong * firstAcross - firstAlong * lastAcross;
+
+        total += std::min(o.area, std::abs(twiceArea) / 2);
+    }
+    return total + BOUND_SLACK;
+}
+
+void CandidateGenerator::best(const IncrementalTerritory& territory, int player, size_t count, const Evaluator& gain,
+                              std::vector<Candidate>& out) {
+    out.clear();
+    if (count == 0) {
+        return;
+    }
+
+    propose(territory, player, scratch);
+    proposed += static_cast<long>(scratch.size());
+
+    // Max-heap on the bound. A coarse entry that reaches the top gets its
+    // refined bound and goes back in; a refined one gets its exact gain.
+    const bool refine = territory.size() > 0;
+    heap.clear();
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        heap.push_back({scratch[i].bound, static_cast<int>(i), !refine});
+    }
+    std::make_heap(heap.begin(), heap.end());
+
+    // `out` stays sorted by decreasing gain and holds at most `count` candidates
+    auto byGain = [](const Candidate& a, const Candidate& b) { return a.gain > b.gain; };
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        Pending top = heap.back();
+        heap.pop_back();
+        if (out.size() == count && top.bound <= out.back().gain) {
+            break; // dominated, and so is every remaining candidate
+        }
+
+        Candidate& candidate = scratch[top.index];
+        if (!top.refined) {
+            candidate.bound = refinedBound(territory, candidate.position);
+            heap.push_back({candidate.bound, top.index, true});
+            std::push_heap(heap.begin(), heap.end());
+            continue;
+        }
+
+        candidate.gain = gain(candidate.position);
+        evaluated++;
+        if (out.size() < count || candidate.gain > out.back().gain) {
+            if (out.size() == count) {
+                out.pop_back();
+            }
+            out.insert(std::upper_bound(out.begin(), out.end(), candidate, byGain), candidate);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef CANDIDATES_HPP
+#define CANDIDATES_HPP
+
+#include <SFML/System.hpp>
+#include <functional>
+#include <vector>
+#include "incremental_territory.hpp"
+
+struct Candidate {
+    sf::Vector2f position;
+    double bound; // upper bound on the gain
+    double gain;  // exact gain, only set by best()
+};
+
+// Turns the continuous board into a finite move list: Voronoi vertices,
+// midpoints of opponent cell edges, cell centroids and a coarse grid.
+//
+// A new site q only takes from a cell c the part closer to q than to its site
+// s_c, i.e. beyond the bisector at d / 2 from s_c, d = |q - s_c|. Two upper
+// bounds on the gain follow, summed over the opponent cells:
+//  - coarse, O(1) per cell: area of c when d < 2 R_c, R_c being its farthest
+//    vertex, 0 otherwise;
+//  - refined, O(vertices): the area of c clipped to the far side of the
+//    bisector, which is exactly what q takes from c. Only a rounding margin
+//    separates it from the gain, so the gains evaluated are mostly the ones
+//    returned.
+// Not thread safe: use one generator per thread.
+class CandidateGenerator {
+public:
+    typedef std::function<double(sf::Vector2f)> Evaluator;
+
+    explicit CandidateGenerator(int gridColumns = 8, int gridRows = 5);
+
+    // Every proposal for `player` with its coarse bound, unsorted
+    void propose(const IncrementalTerritory& territory, int player, std::vector<Candidate>& out);
+
+    // The `count` proposals of highest exact gain, best first. Bounds are
+    // refined and gains evaluated best bound first; the rest is dropped as
+    // soon as no bound can beat the count-th gain found so far.
+    void best(const IncrementalTerritory& territory, int player, size_t count, const Evaluator& gain,
+              std::vector<Candidate>& out);
+
+    // Totals over every best() call, to measure the pruning
+    long proposals() const { return proposed; }
+    long evaluations() const { return evaluated; }
+
+private:
+    struct Opponent {
+        double x;
+        double y;
+        double radius;
+        double area;
+        int site; // cells are looked up again: evaluating a gain may reallocate them
+    };
+
+    struct Pending {
+        double bound;
+        int index;
+        bool refined;
+        bool operator<(const Pending& other) const { return bound < other.bound; }
+    };
+
+    double coarseBound(sf::Vector2f position) const;
+    double refinedBound(const IncrementalTerritory& territory, sf::Vector2f position) const;
+    void add(const IncrementalTerritory& territory, sf::Vector2f position, std::vector<Candidate>& out) const;
+
+    const int GRID_COLUMNS;
+    const int GRID_ROWS;
+    const float MIN_SPACING = 1.0f; // closer than this to a site, a move takes nothing
+    // Added to the refined bound: this clip and IncrementalTerritory's round
+    // differently, and the bound must never fall below the gain
+    const double BOUND_SLACK = 1e-3; // px^2
+
+    std::vector<Opponent> opponents;
+    std::vector<Candidate> scratch;
+    std::vector<Pending> heap;
+    long proposed;
+    long evaluated;
+};
+
+#endif // CANDIDATES_HPP
@@ -0,0 +1,106 @@
+#include "engine.hpp"
+#include "rasterizer.hpp"
+#include "jump_flooding.hpp"
+
+GameEngine::GameEngine(float width, float height, int maxTurns, int players)
+    : WIDTH(width), HEIGHT(height), maxTurns(maxTurns), players(players), player(0), turnCount(0),
+      territory(width, height, players) {}
+
+GameEngine::~GameEngine() = default;
+
+void GameEngine::reset() {
+    territory.reset();
+    player = 0;
+    turnCount = 0;
+}
+
+bool GameEngine::applyMove(sf::Vector2f position) {
+    if (finished() || position.x < 0 || position.y < 0 || position.x > WIDTH || position.y > HEIGHT) {
+        return false;
+    }
+
+    territory.insert(position, player);
+    turnCount++;
+    player = (player + 1) % players;
+    return true;
+}
+
+bool GameEngine::step(const Agent& agent) {
+    if (finished()) {
+        return false;
+    }
+    return applyMove(agent(*this));
+}
+
+void GameEngine::undoMove() {
+    if (turnCount == 0) {
+        return;
+    }
+
+    territory.undo();
+    turnCount--;
+    player = (player + players - 1) % players;
+}
+
+double GameEngine::gain(sf::Vector2f position) {
+    return territory.gain(position, player);
+}
+
+std::vector<double> GameEngine::score(ScoringMode mode) {
+    if (mode == ScoringMode::Pixel) {
+        return pixelTerritoryAreas(sites(), owners(), players, WIDTH, HEIGHT);
+    }
+
+    if (mode == ScoringMode::Raster && sites().size() >= FLOOD_THRESHOLD) {
+        mode = ScoringMode::Flood;
+    }
+
+    if (mode == ScoringMode::Flood) {
+        const std::vector<long>& counts = floodMap().playerCounts();
+        return std::vector<double>(counts.begin(), counts.end());
+    }
+
+    if (mode == ScoringMode::Raster) {
+        if (!rasterizer) {
+            rasterizer.reset(new OwnershipRasterizer(static_cast<int>(WIDTH), static_cast<int>(HEIGHT), threads()));
+        }
+        rasterizer->rasterize(sites(), owners(), players);
+        return std::vector<double>(rasterizer->playerCounts().begin(), rasterizer->playerCounts().end());
+    }
+
+    std::vector<double> areas(players);
+    for (int p = 0; p < players; ++p) {
+        areas[p] = territory.area(p);
+    }
+    return areas;
+}
+
+const JumpFlooding& GameEngine::floodMap() {
+    if (!flood) {
+        flood.reset(new JumpFlooding(static_cast<int>(WIDTH), static_cast<int>(HEIGHT), threads()));
+    }
+    flood->flood(sites(), owners(), players);
+    return *flood;
+}
+
+ThreadPool& GameEngine::threads() {
+    if (!pool) {
+        pool.reset(new ThreadPool());
+    }
+    return *pool;
+}
+
+int GameEngine::winner() {
+    std::vector<double> areas = score();
+    int best = 0;
+    bool tie = false;
+    for (int p = 1; p < players; ++p) {
+        if (areas[p] > areas[best]) {
+            best = p;
+            tie = false;
+        } else if (areas[p] == areas[best]) {
+            tie = true;
+        }
+    }
+    return tie ? -1 : best;
+}
@@ -0,0 +1,72 @@
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include <SFML/System.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "territory.hpp"
+#include "incremental_territory.hpp"
+
+class ThreadPool;
+class OwnershipRasterizer;
+class JumpFlooding;
+
+// Window-free state of a Voronoi game: sites, owners, turns and scores.
+// The SFML Voronoi class is only a view over it; batch jobs use it directly.
+class GameEngine {
+public:
+    // Returns the position the engine's current player should play
+    typedef std::function<sf::Vector2f(GameEngine&)> Agent;
+
+    GameEngine(float width, float height, int maxTurns, int players = 2);
+    ~GameEngine();
+
+    void reset();
+    bool applyMove(sf::Vector2f position); // false if the game is over or the move is off the board
+    bool step(const Agent& agent);         // lets `agent` play the current player's move
+    void undoMove();                       // takes back the last move, O(k) for k neighbours
+
+    // Area owned by each player. Raster falls back to Flood from FLOOD_THRESHOLD
+    // sites on; Exact is kept up to date by the moves and never does
+    std::vector<double> score(ScoringMode mode = ScoringMode::Exact);
+    int winner(); // -1 on a tie
+
+    // Nearest site map of the current position by jump flooding, for views
+    // with more sites than the shader takes
+    const JumpFlooding& floodMap();
+
+    // Territory gained by the current player if it played at `position`
+    double gain(sf::Vector2f position);
+
+    bool finished() const { return turnCount >= maxTurns; }
+    int currentPlayer() const { return player; }
+    int turn() const { return turnCount; }
+    int turnsLeft() const { return maxTurns - turnCount; }
+    int turnLimit() const { return maxTurns; }
+    int playerCount() const { return players; }
+    float width() const { return WIDTH; }
+    float height() const { return HEIGHT; }
+    const std::vector<sf::Vector2f>& sites() const { return territory.sites(); }
+    const std::vector<int>& owners() const { return territory.owners(); }
+    const IncrementalTerritory& cells() const { return territory; }
+
+private:
+    const float WIDTH;
+    const float HEIGHT;
+    const int maxTurns;
+    const int players;
+    int player;
+    int turnCount;
+
+    IncrementalTerritory territory; // keeps the exact score up to date move after move
+
+    ThreadPool& threads();
+
+    // Only built when a Raster or Flood score is requested
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<OwnershipRasterizer> rasterizer;
+    std::unique_ptr<JumpFlooding> flood;
+};
+
+#endif // ENGINE_HPP
@@ -0,0 +1,243 @@
+#include "incremental_territory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+double shoelace(const std::vector<sf::Vector2<double>>& polygon) {
+    double area = 0.0;
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        const sf::Vector2<double>& p = polygon[i];
+        const sf::Vector2<double>& q = polygon[(i + 1) % polygon.size()];
+        area += p.x * q.y - q.x * p.y;
+    }
+    return std::abs(area) / 2.0;
+}
+
+// Vertices closer than this (in px^2 units of the bisector equation) count as on the bisector
+const double CLIP_EPSILON = 1e-6;
+
+}
+
+IncrementalTerritory::IncrementalTerritory(float width, float height, int players)
+    : WIDTH(width), HEIGHT(height), totals(players, 0.0), hint(-1), stamp(0) {}
+
+void IncrementalTerritory::reset() {
+    sitePositions.clear();
+    siteOwners.clear();
+    cells.clear();
+    std::fill(totals.begin(), totals.end(), 0.0);
+    frames.clear();
+    changes.clear();
+    hint = -1;
+}
+
+void IncrementalTerritory::assign(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners) {
+    reset();
+    for (size_t i = 0; i < sites.size(); ++i) {
+        insert(sites[i], owners[i]);
+    }
+}
+
+IncrementalTerritory::Cell IncrementalTerritory::board() const {
+    Cell cell;
+    cell.vertices = {{0.0, 0.0}, {double(WIDTH), 0.0}, {double(WIDTH), double(HEIGHT)}, {0.0, double(HEIGHT)}};
+    cell.labels = {-1, -1, -1, -1};
+    cell.area = double(WIDTH) * double(HEIGHT);
+    return cell;
+}
+
+bool IncrementalTerritory::clip(const Cell& cell, int site, int other, Cell& out) const {
+    const double sx = sitePositions[site].x;
+    const double sy = sitePositions[site].y;
+    const double nx = sitePositions[other].x;
+    const double ny = sitePositions[other].y;
+    if (sx == nx && sy == ny) {
+        return false;
+    }
+
+    // Keep the points p with a.p <= b, i.e. closer to `site` than to `other`
+    const double ax = nx - sx;
+    const double ay = ny - sy;
+    const double b = 0.5 * (nx * nx + ny * ny - sx * sx - sy * sy);
+
+    bool cut = false;
+    for (const auto& v : cell.vertices) {
+        if (ax * v.x + ay * v.y - b > CLIP_EPSILON) {
+            cut = true;
+            break;
+        }
+    }
+    if (!cut) {
+        return false;
+    }
+
+    out.vertices.clear();
+    out.labels.clear();
+    const size_t count = cell.vertices.size();
+    for (size_t i = 0; i < count; ++i) {
+        const sf::Vector2<double>& p = cell.vertices[i];
+        const sf::Vector2<double>& q = cell.vertices[(i + 1) % count];
+        double dp = ax * p.x + ay * p.y - b;
+        double dq = ax * q.x + ay * q.y - b;
+
+        if (dp <= CLIP_EPSILON) {
+            out.vertices.push_back(p);
+            out.labels.push_back(cell.labels[i]);
+            if (dq > CLIP_EPSILON) {
+                // Leaving: the edge along the bisector starts here
+                double t = dp / (dp - dq);
+                out.vertices.emplace_back(p.x + t * (q.x - p.x), p.y + t * (q.y - p.y));
+                out.labels.push_back(other);
+            }
+        } else if (dq <= CLIP_EPSILON) {
+            // Entering: the rest of edge i is kept
+            double t = dp / (dp - dq);
+            out.vertices.emplace_back(p.x + t * (q.x - p.x), p.y + t * (q.y - p.y));
+            out.labels.push_back(cell.labels[i]);
+        }
+    }
+
+    if (out.vertices.size() < 3) {
+        out.vertices.clear();
+        out.labels.clear();
+        out.area = 0.0;
+    } else {
+        out.area = shoelace(out.vertices);
+    }
+    return true;
+}
+
+int IncrementalTerritory::nearestSite(sf::Vector2f position) const {
+    if (hint < 0) {
+        return -1;
+    }
+
+    // Greedy walk over the cell adjacency: inside the board it ends at the nearest site
+    auto dist = [&](int site) {
+        double dx = double(sitePositions[site].x) - position.x;
+        double dy = double(sitePositions[site].y) - position.y;
+        return dx * dx + dy * dy;
+    };
+
+    int current = hint;
+    double best = dist(current);
+    bool moved = true;
+    while (moved) {
+        moved = false;
+        int next = current;
+        for (int label : cells[current].labels) {
+            if (label >= 0) {
+                double d = dist(label);
+                if (d < best) {
+                    best = d;
+                    next = label;
+                }
+            }
+        }
+        if (next != current) {
+            current = next;
+            moved = true;
+        }
+    }
+
+    return current;
+}
+
+int IncrementalTerritory::insert(sf::Vector2f position, int owner) {
+    const int id = static_cast<int>(sitePositions.size());
+    frames.push_back({hint, changes.size()});
+
+    if (id == 0) {
+        sitePositions.push_back(position);
+        siteOwners.push_back(owner);
+        cells.push_back(board());
+        totals[owner] += cells.back().area;
+        hint = id;
+        return id;
+    }
+
+    const int nearest = nearestSite(position);
+    sitePositions.push_back(position);
+    siteOwners.push_back(owner);
+    cells.emplace_back();
+
+    // Same spot as an existing site: the older one keeps the cell
+    if (sitePositions[nearest] == position) {
+        return id;
+    }
+
+    if (visited.size() < sitePositions.size()) {
+        visited.resize(sitePositions.size() * 2, 0);
+    }
+    ++stamp;
+
+    // The cells losing area to the new site are connected: grow from the nearest one
+    Cell newCell = board();
+    Cell clipped;
+    queue.clear();
+    queue.push_back(nearest);
+    visited[nearest] = stamp;
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const int site = queue[head];
+        if (!clip(cells[site], site, id, clipped)) {
+            continue;
+        }
+
+        std::swap(cells[site], clipped);
+        totals[siteOwners[site]] += cells[site].area - clipped.area;
+        for (int label : clipped.labels) {
+            if (label >= 0 && visited[label] != stamp) {
+                visited[label] = stamp;
+                queue.push_back(label);
+            }
+        }
+        changes.push_back({site, std::move(clipped)});
+
+        if (clip(newCell, id, site, clipped)) {
+            std::swap(newCell, clipped);
+        }
+    }
+
+    totals[owner] += newCell.area;
+    cells[id] = std::move(newCell);
+    if (cells[id].area > 0.0) {
+        hint = id;
+    }
+
+    return id;
+}
+
+void IncrementalTerritory::undo() {
+    if (frames.empty()) {
+        return;
+    }
+
+    const Frame frame = frames.back();
+    frames.pop_back();
+
+    const int id = static_cast<int>(sitePositions.size()) - 1;
+    totals[siteOwners[id]] -= cells[id].area;
+
+    while (changes.size() > frame.changes) {
+        Change& change = changes.back();
+        totals[siteOwners[change.site]] += change.before.area - cells[change.site].area;
+        cells[change.site] = std::move(change.before);
+        changes.pop_back();
+    }
+
+    sitePositions.pop_back();
+    siteOwners.pop_back();
+    cells.pop_back();
+    hint = frame.hint;
+}
+
+double IncrementalTerritory::gain(sf::Vector2f position, int owner) {
+    double before = totals[owner];
+    insert(position, owner);
+    double after = totals[owner];
+    undo();
+    return after - before;
+}
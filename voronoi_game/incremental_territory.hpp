@@ -0,0 +1,70 @@
+#ifndef INCREMENTAL_TERRITORY_HPP
+#define INCREMENTAL_TERRITORY_HPP
+
+#include <SFML/System.hpp>
+#include <vector>
+
+// Keeps every Voronoi cell clipped to the board and the area owned by each
+// player. Inserting a site only clips the cells it steals from, i.e. its k
+// Voronoi neighbours, and undo restores them: both are O(k).
+// Sites must lie inside the board.
+class IncrementalTerritory {
+public:
+    struct Cell {
+        std::vector<sf::Vector2<double>> vertices;
+        std::vector<int> labels; // labels[i]: site across edge (vertices[i], vertices[i + 1]), -1 for the border
+        double area = 0.0;
+    };
+
+    IncrementalTerritory(float width, float height, int players = 2);
+
+    void reset();
+    void assign(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners);
+    int insert(sf::Vector2f position, int owner);
+    void undo(); // removes the last inserted site
+
+    // Change of `owner`'s area if it placed a site at `position`
+    double gain(sf::Vector2f position, int owner);
+
+    int nearestSite(sf::Vector2f position) const;
+
+    double area(int player) const { return totals[player]; }
+    size_t size() const { return sitePositions.size(); }
+    const std::vector<sf::Vector2f>& sites() const { return sitePositions; }
+    const std::vector<int>& owners() const { return siteOwners; }
+    const Cell& cell(int site) const { return cells[site]; }
+    float width() const { return WIDTH; }
+    float height() const { return HEIGHT; }
+
+private:
+    struct Change {
+        int site;
+        Cell before;
+    };
+
+    struct Frame {
+        int hint;
+        size_t changes; // size of `changes` before the insert
+    };
+
+    bool clip(const Cell& cell, int site, int other, Cell& out) const;
+    Cell board() const;
+
+    const float WIDTH;
+    const float HEIGHT;
+
+    std::vector<sf::Vector2f> sitePositions;
+    std::vector<int> siteOwners;
+    std::vector<Cell> cells;
+    std::vector<double> totals;
+
+    std::vector<Frame> frames;
+    std::vector<Change> changes;
+    int hint; // a site with a non-empty cell, where nearest site walks start
+
+    std::vector<int> queue;
+    std::vector<unsigned> visited;
+    unsigned stamp;
+};
+
+#endif // INCREMENTAL_TERRITORY_HPP
@@ -0,0 +1,262 @@
+#include "jump_flooding.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JUMP_FLOODING_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// relaxRow on [x, x1) by groups of lanes, returns the first pixel left
+#ifdef JUMP_FLOODING_AVX2
+// Compiled for AVX2 without -mavx2, only called when the processor has it
+__attribute__((target("avx2"))) int relaxAvx2(int x, int x1, int shift, float py, const int* ids, const float* sx,
+                                              const float* sy, int* bestId, float* bestX, float* bestY, float* bestDist) {
+    const __m256 lanes = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 vy = _mm256_set1_ps(py);
+    for (; x + 8 <= x1; x += 8) {
+        const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lanes);
+        const __m256 cx = _mm256_loadu_ps(sx + x + shift);
+        const __m256 cy = _mm256_loadu_ps(sy + x + shift);
+        const __m256i id = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + x + shift));
+        const __m256 dx = _mm256_sub_ps(px, cx);
+        const __m256 dy = _mm256_sub_ps(vy, cy);
+        const __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+        const __m256 best = _mm256_loadu_ps(bestDist + x);
+        const __m256i bestIds = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bestId + x));
+        const __m256 tie = _mm256_and_ps(_mm256_cmp_ps(d, best, _CMP_EQ_OQ),
+                                         _mm256_castsi256_ps(_mm256_cmpgt_epi32(bestIds, id)));
+        const __m256 closer = _mm256_or_ps(_mm256_cmp_ps(d, best, _CMP_LT_OQ), tie);
+
+        _mm256_storeu_ps(bestDist + x, _mm256_min_ps(d, best)); // equal on a tie
+        _mm256_storeu_ps(bestX + x, _mm256_blendv_ps(_mm256_loadu_ps(bestX + x), cx, closer));
+        _mm256_storeu_ps(bestY + x, _mm256_blendv_ps(_mm256_loadu_ps(bestY + x), cy, closer));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(bestId + x),
+                            _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIds), _mm256_castsi256_ps(id), closer)));
+    }
+    return x;
+}
+#endif
+
+#if defined(__SSE2__)
+int relaxSse2(int x, int x1, int shift, float py, const int* ids, const float* sx, const float* sy,
+              int* bestId, float* bestX, float* bestY, float* bestDist) {
+    const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 vy = _mm_set1_ps(py);
+    for (; x + 4 <= x1; x += 4) {
+        const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+        const __m128 cx = _mm_loadu_ps(sx + x + shift);
+        const __m128 cy = _mm_loadu_ps(sy + x + shift);
+        const __m128i id = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + x + shift));
+        const __m128 dx = _mm_sub_ps(px, cx);
+        const __m128 dy = _mm_sub_ps(vy, cy);
+        const __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+        const __m128 best = _mm_loadu_ps(bestDist + x);
+        const __m128i bestIds = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bestId + x));
+        const __m128 tie = _mm_and_ps(_mm_cmpeq_ps(d, best), _mm_castsi128_ps(_mm_cmpgt_epi32(bestIds, id)));
+        const __m128 closer = _mm_or_ps(_mm_cmplt_ps(d, best), tie);
+        auto blend = [&closer](__m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(closer, b), _mm_andnot_ps(closer, a)); };
+
+        _mm_storeu_ps(bestDist + x, _mm_min_ps(d, best)); // equal on a tie
+        _mm_storeu_ps(bestX + x, blend(_mm_loadu_ps(bestX + x), cx));
+        _mm_storeu_ps(bestY + x, blend(_mm_loadu_ps(bestY + x), cy));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bestId + x),
+                         _mm_castps_si128(blend(_mm_castsi128_ps(bestIds), _mm_castsi128_ps(id))));
+    }
+    return x;
+}
+#endif
+
+bool supportsAvx2() {
+#ifdef JUMP_FLOODING_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// best[x] = closest of best[x] and the site seen at pixel x + shift of `ids` /
+// `sx` / `sy`, for x in [x0, x1) on the row of centre py; ties go to the lowest index
+void relaxRow(bool avx2, int x0, int x1, int shift, float py, const int* ids, const float* sx, const float* sy,
+              int* bestId, float* bestX, float* bestY, float* bestDist) {
+    int x = x0;
+#ifdef JUMP_FLOODING_AVX2
+    if (avx2) {
+        x = relaxAvx2(x, x1, shift, py, ids, sx, sy, bestId, bestX, bestY, bestDist);
+    }
+#endif
+#if defined(__SSE2__)
+    x = relaxSse2(x, x1, shift, py, ids, sx, sy, bestId, bestX, bestY, bestDist);
+#endif
+    for (; x < x1; ++x) {
+        const float dx = x + 0.5f - sx[x + shift];
+        const float dy = py - sy[x + shift];
+        const float d = dx * dx + dy * dy;
+        if (d < bestDist[x] || (d == bestDist[x] && ids[x + shift] < bestId[x])) {
+            bestDist[x] = d;
+            bestId[x] = ids[x + shift];
+            bestX[x] = sx[x + shift];
+            bestY[x] = sy[x + shift];
+        }
+    }
+}
+
+}
+
+JumpFlooding::JumpFlooding(int width, int height, ThreadPool& pool)
+    : WIDTH(width), HEIGHT(height), bands((height + BAND - 1) / BAND), pool(pool), players(0),
+      avx2(supportsAvx2()), current(0), distances(width * height, 0.0f), bandCounts(bands) {
+    for (Planes& p : planes) {
+        p.ids.assign(width * height, -1);
+        p.xs.assign(width * height, EMPTY);
+        p.ys.assign(width * height, EMPTY);
+        p.dists.assign(width * height, 0.0f);
+    }
+}
+
+void JumpFlooding::flood(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners, int playerCount) {
+    players = playerCount;
+    siteOwners = owners;
+    xs.resize(sites.size());
+    ys.resize(sites.size());
+    for (size_t i = 0; i < sites.size(); ++i) {
+        xs[i] = sites[i].x;
+        ys[i] = sites[i].y;
+    }
+
+    seed(planes[0]);
+
+    int step = 1;
+    while (step < std::max(WIDTH, HEIGHT)) {
+        step *= 2;
+    }
+
+    current = 0;
+    for (step /= 2; step >= 1; step /= 2) {
+        pass(step, planes[current], planes[1 - current]);
+        current = 1 - current;
+    }
+    pass(1, planes[current], planes[1 - current]);
+    current = 1 - current;
+
+    pool.parallelFor(bands, [this](size_t band) { finish(band); });
+
+    counts.assign(players, 0);
+    for (const auto& band : bandCounts) {
+        for (int p = 0; p < players; ++p) {
+            counts[p] += band[p];
+        }
+    }
+}
+
+void JumpFlooding::seed(Planes& planes) {
+    std::fill(planes.ids.begin(), planes.ids.end(), -1);
+    std::fill(planes.xs.begin(), planes.xs.end(), EMPTY);
+    std::fill(planes.ys.begin(), planes.ys.end(), EMPTY);
+
+    // A site whose pixel is taken seeds the nearest free one instead: distances
+    // always use its true position, and a site that seeds nothing would be lost
+    for (size_t i = 0; i < xs.size(); ++i) {
+        const int px = std::min(std::max(static_cast<int>(xs[i]), 0), WIDTH - 1);
+        const int py = std::min(std::max(static_cast<int>(ys[i]), 0), HEIGHT - 1);
+        for (int radius = 0; radius < std::max(WIDTH, HEIGHT); ++radius) {
+            bool placed = false;
+            for (int y = std::max(py - radius, 0); y <= std::min(py + radius, HEIGHT - 1) && !placed; ++y) {
+                for (int x = std::max(px - radius, 0); x <= std::min(px + radius, WIDTH - 1); ++x) {
+                    const size_t cell = static_cast<size_t>(y) * WIDTH + x;
+                    if (planes.ids[cell] < 0) {
+                        planes.ids[cell] = static_cast<int>(i);
+                        planes.xs[cell] = xs[i];
+                        planes.ys[cell] = ys[i];
+                        placed = true;
+                        break;
+                    }
+                }
+            }
+            if (placed) {
+                break;
+            }
+        }
+    }
+}
+
+void JumpFlooding::pass(int step, const Planes& from, Planes& to) {
+    pool.parallelFor(bands, [&](size_t band) {
+        const int y0 = static_cast<int>(band) * BAND;
+        const int y1 = std::min(y0 + BAND, HEIGHT);
+
+        for (int y = y0; y < y1; ++y) {
+            const float py = y + 0.5f;
+            const size_t offset = static_cast<size_t>(y) * WIDTH;
+            int* bestId = &to.ids[offset];
+            float* bestX = &to.xs[offset];
+            float* bestY = &to.ys[offset];
+            float* bestDist = &to.dists[offset];
+
+            std::copy(&from.ids[offset], &from.ids[offset] + WIDTH, bestId);
+            std::copy(&from.xs[offset], &from.xs[offset] + WIDTH, bestX);
+            std::copy(&from.ys[offset], &from.ys[offset] + WIDTH, bestY);
+            for (int x = 0; x < WIDTH; ++x) {
+                const float dx = x + 0.5f - bestX[x];
+                const float dy = py - bestY[x];
+                bestDist[x] = dx * dx + dy * dy;
+            }
+
+            // The 8 neighbours one offset at a time, as sweeps over contiguous
+            // rows. Empty pixels sit at EMPTY and never win.
+            for (int oy = -step; oy <= step; oy += step) {
+                const int ny = y + oy;
+                if (ny < 0 || ny >= HEIGHT) {
+                    continue;
+                }
+                const size_t row = static_cast<size_t>(ny) * WIDTH;
+                for (int ox = -step; ox <= step; ox += step) {
+                    if (ox == 0 && oy == 0) {
+                        continue;
+                    }
+                    // Pixel x reads pixel x + ox of the neighbour row
+                    relaxRow(avx2, std::max(0, -ox), std::min(WIDTH, WIDTH - ox), ox, py, from.ids.data() + row,
+                             from.xs.data() + row, from.ys.data() + row, bestId, bestX, bestY, bestDist);
+                }
+            }
+        }
+    });
+}
+
+void JumpFlooding::finish(size_t band) {
+    const int y0 = static_cast<int>(band) * BAND;
+    const int y1 = std::min(y0 + BAND, HEIGHT);
+    const Planes& result = planes[current];
+    std::vector<long>& count = bandCounts[band];
+    count.assign(players, 0);
+
+    for (size_t i = static_cast<size_t>(y0) * WIDTH; i < static_cast<size_t>(y1) * WIDTH; ++i) {
+        const int site = result.ids[i];
+        if (site < 0) {
+            distances[i] = std::numeric_limits<float>::infinity();
+            continue;
+        }
+        distances[i] = std::sqrt(result.dists[i]);
+        count[siteOwners[site]]++;
+    }
+}
+
+void JumpFlooding::toImage(sf::Image& image, const std::vector<sf::Color>& palette) const {
+    const std::vector<int>& siteIds = planes[current].ids;
+    std::vector<sf::Uint8> pixels(siteIds.size() * 4);
+    for (size_t i = 0; i < siteIds.size(); ++i) {
+        sf::Color color = (siteIds[i] >= 0) ? palette[siteOwners[siteIds[i]]] : sf::Color::White;
+        pixels[4 * i + 0] = color.r;
+        pixels[4 * i + 1] = color.g;
+        pixels[4 * i + 2] = color.b;
+        pixels[4 * i + 3] = color.a;
+    }
+    image.create(WIDTH, HEIGHT, pixels.data());
+}
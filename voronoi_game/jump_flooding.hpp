@@ -0,0 +1,66 @@
+#ifndef JUMP_FLOODING_HPP
+#define JUMP_FLOODING_HPP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "thread_pool.hpp"
+
+// Nearest site map and distance field by jump flooding, sampled at pixel
+// centres like OwnershipRasterizer. Every site seeds the pixel it lies in,
+// then each pass lets every pixel adopt the nearest site seen by its 8
+// neighbours at distance step, for step = N/2, N/4 ... 1, plus one more pass
+// at step 1 that fixes most of the remaining errors. The cost is
+// O(W * H * log max(W, H)) whatever the number of sites; the result is
+// approximate, with under 0.01% of the pixels given a farther site than the
+// nearest one (./simulate flood).
+class JumpFlooding {
+public:
+    JumpFlooding(int width, int height, ThreadPool& pool);
+
+    void flood(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners, int players);
+
+    // Site index of every pixel, row-major, -1 when there is no site
+    const std::vector<int>& siteBuffer() const { return planes[current].ids; }
+    // Distance from every pixel centre to its site, in pixels
+    const std::vector<float>& distanceField() const { return distances; }
+    const std::vector<long>& playerCounts() const { return counts; }
+
+    void toImage(sf::Image& image, const std::vector<sf::Color>& palette) const;
+
+private:
+    // Per pixel: its site and a copy of the site position, so that passes read
+    // contiguous rows instead of gathering positions by index
+    struct Planes {
+        std::vector<int> ids;
+        std::vector<float> xs;
+        std::vector<float> ys;
+        std::vector<float> dists; // squared
+    };
+
+    void seed(Planes& planes);
+    void pass(int step, const Planes& from, Planes& to);
+    void finish(size_t band);
+
+    const float EMPTY = 1e18f; // position of the pixels without site, its squared distance still fits a float
+
+    const int WIDTH;
+    const int HEIGHT;
+    const int BAND = 16; // rows per task
+    const int bands;
+    ThreadPool& pool;
+
+    // SoA copy of the sites of the current call
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<int> siteOwners;
+    int players;
+
+    const bool avx2; // checked once at run time, the build doesn't assume it
+    Planes planes[2]; // ping-pong buffers of the passes
+    int current;      // the one holding the result
+    std::vector<float> distances;
+    std::vector<long> counts;
+    std::vector<std::vector<long>> bandCounts;
+};
+
+#endif // JUMP_FLOODING_HPP
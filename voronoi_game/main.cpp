@@ -4,8 +4,9 @@ int main() {
     const int WIDTH = 1200;
     const int HEIGHT = 800;
     const int MAX_TURNS = 10; // Nombre de tours par joueur
+    const int AI_PLAYER = 1;  // Le joueur bleu est joué par l'IA
 
-    Voronoi game(WIDTH, HEIGHT, MAX_TURNS);
+    Voronoi game(WIDTH, HEIGHT, MAX_TURNS, AI_PLAYER);
     game.run();
 
     return 0;
@@ -0,0 +1,199 @@
+#include "mcts.hpp"
+#include "agents.hpp"
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+GameEngine::Agent MctsConfig::randomAgentFactory(unsigned seed) {
+    return randomAgent(seed);
+}
+
+MctsAI::Node::Node(sf::Vector2f move, int player, int capacity)
+    : move(move), player(player), visits(0), pending(0), reward(0), childCount(0),
+      children(new std::atomic<Node*>[capacity]) {
+    expanding.clear();
+}
+
+MctsAI::MctsAI(MctsConfig config)
+    : config(config), pool(config.threads > 0 ? config.threads : 1), workers(pool.size()),
+      playouts(0), stop(false), searches(0) {}
+
+MctsResult MctsAI::chooseMove(const GameEngine& state) {
+    auto start = std::chrono::steady_clock::now();
+    deadline = start + std::chrono::milliseconds(config.timeBudgetMs);
+    playouts = 0;
+    stop = false;
+    searches++;
+
+    const int previous = (state.currentPlayer() + state.playerCount() - 1) % state.playerCount();
+    root.reset(new Node(sf::Vector2f(), previous, config.maxChildren));
+
+    // Every worker replays the position on its own engine and walks the shared tree
+    for (size_t w = 0; w < workers.size(); ++w) {
+        Worker& worker = workers[w];
+        worker.engine.reset(new GameEngine(state.width(), state.height(), state.turnLimit(), state.playerCount()));
+        for (sf::Vector2f site : state.sites()) {
+            worker.engine->applyMove(site);
+        }
+        const unsigned seed = static_cast<unsigned>(searches * 7919u + w * 104729u);
+        worker.gen.seed(seed);
+        worker.policy = config.playoutPolicy(seed);
+        worker.nodes.clear();
+    }
+
+    pool.parallelFor(workers.size(), [this](size_t w) { search(workers[w]); });
+
+    MctsResult result;
+    result.move = sf::Vector2f(state.width() / 2, state.height() / 2);
+    result.playouts = playouts;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.value = 0.0;
+    result.nodes = 1;
+    for (const Worker& worker : workers) {
+        result.nodes += worker.nodes.size();
+    }
+
+    // Most visited child: more robust than the best average on few playouts
+    int bestVisits = -1;
+    int count = root->childCount.load();
+    for (int i = 0; i < count; ++i) {
+        Node* child = root->children[i].load();
+        int visits = child->visits.load();
+        if (visits > bestVisits) {
+            bestVisits = visits;
+            result.move = child->move;
+            result.value = visits > 0 ? child->reward.load() / (2.0 * visits) : 0.0;
+        }
+    }
+
+    return result;
+}
+
+void MctsAI::search(Worker& worker) {
+    GameEngine& engine = *worker.engine;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        // Selection and expansion: stop at the first node created by this descent
+        worker.path.clear();
+        worker.path.push_back(root.get());
+        Node* node = root.get();
+        bool created = false;
+        while (!created && !engine.finished()) {
+            node = descend(node, worker, created);
+            node->pending.fetch_add(config.virtualLoss, std::memory_order_relaxed);
+            engine.applyMove(node->move);
+            worker.path.push_back(node);
+        }
+
+        // Playout
+        int moves = static_cast<int>(worker.path.size()) - 1;
+        while (engine.step(worker.policy)) {
+            moves++;
+        }
+        int winner = engine.winner();
+
+        // Backpropagation
+        for (size_t i = 0; i < worker.path.size(); ++i) {
+            Node* n = worker.path[i];
+            long long points = (winner < 0) ? 1 : (winner == n->player ? 2 : 0);
+            n->reward.fetch_add(points, std::memory_order_relaxed);
+            n->visits.fetch_add(1, std::memory_order_relaxed);
+            if (i > 0) {
+                n->pending.fetch_sub(config.virtualLoss, std::memory_order_relaxed);
+            }
+        }
+
+        for (int i = 0; i < moves; ++i) {
+            engine.undoMove();
+        }
+
+        long done = playouts.fetch_add(1, std::memory_order_relaxed) + 1;
+        if ((config.maxPlayouts > 0 && done >= config.maxPlayouts) || std::chrono::steady_clock::now() >= deadline) {
+            stop = true;
+        }
+    }
+}
+
+MctsAI::Node* MctsAI::descend(Node* node, Worker& worker, bool& created) {
+    int count = node->childCount.load(std::memory_order_acquire);
+    int total = node->visits.load(std::memory_order_relaxed) + node->pending.load(std::memory_order_relaxed);
+
+    // Progressive widening: the number of children grows with the visits
+    int allowed = static_cast<int>(std::ceil(config.wideningC * std::pow(total + 1.0, config.wideningAlpha)));
+    allowed = std::min(std::max(allowed, 1), config.maxChildren);
+
+    if (count < allowed && !node->expanding.test_and_set(std::memory_order_acquire)) {
+        count = node->childCount.load(std::memory_order_relaxed);
+        if (count < allowed) {
+            worker.nodes.emplace_back(nextMove(node, count, worker), worker.engine->currentPlayer(), config.maxChildren);
+            Node* child = &worker.nodes.back();
+            node->children[count].store(child, std::memory_order_release);
+            node->childCount.store(count + 1, std::memory_order_release);
+            node->expanding.clear(std::memory_order_release);
+            created = true;
+            return child;
+        }
+        node->expanding.clear(std::memory_order_release);
+    }
+
+    // Another worker is adding the very first child
+    while (count == 0) {
+        std::this_thread::yield();
+        count = node->childCount.load(std::memory_order_acquire);
+    }
+
+    // UCT, a virtual loss counting as a visit without reward
+    Node* best = nullptr;
+    double bestScore = -std::numeric_limits<double>::infinity();
+    const double logTotal = std::log(std::max(total, 1));
+    for (int i = 0; i < count; ++i) {
+        Node* child = node->children[i].load(std::memory_order_acquire);
+        int n = child->visits.load(std::memory_order_relaxed) + child->pending.load(std::memory_order_relaxed);
+        if (n == 0) {
+            return child;
+        }
+        double mean = child->reward.load(std::memory_order_relaxed) / (2.0 * n);
+        double score = mean + config.exploration * std::sqrt(logTotal / n);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
+sf::Vector2f MctsAI::nextMove(Node* node, int index, Worker& worker) {
+    GameEngine& engine = *worker.engine;
+    if (index == 0 && config.proposals > 0) {
+        worker.candidates.best(engine.cells(), engine.currentPlayer(), config.proposals,
+                               [&engine](sf::Vector2f position) { return engine.gain(position); }, worker.scored);
+        for (const Candidate& candidate : worker.scored) {
+            node->proposals.push_back(candidate.position);
+        }
+    }
+
+    if (index < static_cast<int>(node->proposals.size())) {
+        return node->proposals[index];
+    }
+    return sampleMove(worker);
+}
+
+sf::Vector2f MctsAI::sampleMove(Worker& worker) {
+    GameEngine& engine = *worker.engine;
+    std::uniform_real_distribution<float> x(0.0f, engine.width());
+    std::uniform_real_distribution<float> y(0.0f, engine.height());
+
+    sf::Vector2f best(x(worker.gen), y(worker.gen));
+    double bestGain = engine.gain(best);
+    for (int s = 1; s < config.samples; ++s) {
+        sf::Vector2f candidate(x(worker.gen), y(worker.gen));
+        double gain = engine.gain(candidate);
+        if (gain > bestGain) {
+            bestGain = gain;
+            best = candidate;
+        }
+    }
+    return best;
+}
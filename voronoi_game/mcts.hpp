@@ -0,0 +1,96 @@
+#ifndef MCTS_HPP
+#define MCTS_HPP
+
+#include <SFML/System.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "engine.hpp"
+#include "candidates.hpp"
+#include "thread_pool.hpp"
+
+struct MctsConfig {
+    unsigned threads = std::thread::hardware_concurrency();
+    int timeBudgetMs = 100;
+    long maxPlayouts = 0;       // 0: stop on the time budget only
+    double exploration = 0.7;   // UCT constant, rewards are in [0, 1]
+    double wideningC = 1.0;     // a node with n visits may have ceil(C * (n + 1)^alpha) children
+    double wideningAlpha = 0.5;
+    int maxChildren = 48;
+    int proposals = 4;          // first children: best gains of the candidate generator
+    int samples = 4;            // later ones: best gain among this many random placements
+    int virtualLoss = 1;
+
+    // Builds the agent playing both sides after the tree, one per worker
+    std::function<GameEngine::Agent(unsigned seed)> playoutPolicy = randomAgentFactory;
+
+    static GameEngine::Agent randomAgentFactory(unsigned seed);
+};
+
+struct MctsResult {
+    sf::Vector2f move;
+    long playouts;
+    double seconds;
+    double value;   // win rate of the chosen move
+    size_t nodes;
+};
+
+// Monte Carlo tree search with progressive widening over the continuous board.
+// All workers share one tree: statistics are atomics updated without locks, a
+// virtual loss steers concurrent descents apart, and a per-node spin flag only
+// guards the insertion of a new child.
+class MctsAI {
+public:
+    explicit MctsAI(MctsConfig config = MctsConfig());
+
+    MctsResult chooseMove(const GameEngine& state);
+    const MctsConfig& settings() const { return config; }
+
+private:
+    struct Node {
+        Node(sf::Vector2f move, int player, int capacity);
+
+        sf::Vector2f move;
+        int player; // who played `move`, rewards are counted for them
+
+        std::atomic<int> visits;
+        std::atomic<int> pending;        // virtual losses of the descents in flight
+        std::atomic<long long> reward;   // in half points: 2 per win, 1 per tie
+        std::atomic<int> childCount;
+        std::atomic_flag expanding;
+        std::unique_ptr<std::atomic<Node*>[]> children;
+        std::vector<sf::Vector2f> proposals; // filled with the first child, only read under `expanding`
+    };
+
+    struct Worker {
+        std::unique_ptr<GameEngine> engine;
+        GameEngine::Agent policy;
+        std::deque<Node> nodes; // stable addresses, freed with the next search
+        std::vector<Node*> path;
+        CandidateGenerator candidates;
+        std::vector<Candidate> scored;
+        std::mt19937 gen; // reseeded by each search, drawn by sampleMove
+    };
+
+    void search(Worker& worker);
+    Node* descend(Node* node, Worker& worker, bool& created);
+    sf::Vector2f nextMove(Node* node, int index, Worker& worker);
+    sf::Vector2f sampleMove(Worker& worker);
+
+    MctsConfig config;
+    ThreadPool pool;
+    std::vector<Worker> workers;
+    std::unique_ptr<Node> root;
+
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<long> playouts;
+    std::atomic<bool> stop;
+    unsigned searches;
+};
+
+#endif // MCTS_HPP
@@ -0,0 +1,167 @@
+#include "minimax.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    // splitmix64 finalizer
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+}
+
+MinimaxAI::MinimaxAI(float width, float height, int timeBudgetMs)
+    : WIDTH(width), HEIGHT(height), budget(timeBudgetMs), timeUp(false), nodes(0),
+      territory(width, height), candidates(GRID_COLUMNS, GRID_ROWS), hash(0) {}
+
+uint64_t MinimaxAI::siteKey(sf::Vector2f position, int owner) const {
+    uint64_t qx = static_cast<uint64_t>(std::lround(position.x / TT_QUANTUM));
+    uint64_t qy = static_cast<uint64_t>(std::lround(position.y / TT_QUANTUM));
+    return mix((qx << 33) ^ (qy << 2) ^ static_cast<uint64_t>(owner));
+}
+
+SearchResult MinimaxAI::chooseMove(const std::vector<sf::Vector2f>& currentSites, const std::vector<int>& currentOwners,
+                                   int player, int turnsLeft) {
+    territory.assign(currentSites, currentOwners);
+    hash = 0;
+    for (size_t i = 0; i < currentSites.size(); ++i) {
+        hash += siteKey(currentSites[i], currentOwners[i]);
+    }
+
+    deadline = std::chrono::steady_clock::now() + budget;
+    timeUp = false;
+    nodes = 0;
+
+    SearchResult result = {sf::Vector2f(WIDTH / 2, HEIGHT / 2), 0, 0.0, 0};
+    std::vector<sf::Vector2f> moves;
+    orderedMoves(player, nullptr, moves);
+    if (!moves.empty()) {
+        result.move = moves.front();
+    }
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    const int maxDepth = (turnsLeft < MAX_DEPTH) ? turnsLeft : MAX_DEPTH;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        sf::Vector2f move = result.move;
+        double value = search(depth, -infinity, infinity, player, turnsLeft, &move);
+        if (timeUp) {
+            break; // keep the move of the last completed iteration
+        }
+        result.move = move;
+        result.depth = depth;
+        result.value = value;
+    }
+
+    result.nodes = nodes;
+    if (table.size() > MAX_TABLE_SIZE) {
+        table.clear();
+    }
+    return result;
+}
+
+double MinimaxAI::search(int depth, double alpha, double beta, int player, int turnsLeft, sf::Vector2f* best) {
+    if ((++nodes & 63) == 0 && std::chrono::steady_clock::now() > deadline) {
+        timeUp = true;
+    }
+    if (timeUp) {
+        return 0.0;
+    }
+
+    if (depth == 0 || turnsLeft == 0) {
+        return evaluate(player);
+    }
+
+    const uint64_t key = hash ^ mix(static_cast<uint64_t>(turnsLeft) * 2 + player);
+    const double alphaOrig = alpha;
+    bool hasTableMove = false;
+    sf::Vector2f tableMove;
+
+    auto it = table.find(key);
+    if (it != table.end()) {
+        const Entry& entry = it->second;
+        hasTableMove = true;
+        tableMove = entry.best;
+
+        if (entry.depth >= depth && !best) {
+            if (entry.bound == Bound::Exact) {
+                return entry.value;
+            } else if (entry.bound == Bound::Lower) {
+                alpha = std::max(alpha, entry.value);
+            } else {
+                beta = std::min(beta, entry.value);
+            }
+            if (alpha >= beta) {
+                return entry.value;
+            }
+        }
+    }
+
+    std::vector<sf::Vector2f> moves;
+    orderedMoves(player, hasTableMove ? &tableMove : nullptr, moves);
+
+    double bestValue = -std::numeric_limits<double>::infinity();
+    sf::Vector2f bestMove = moves.empty() ? sf::Vector2f() : moves.front();
+
+    for (const auto& move : moves) {
+        const uint64_t moveKey = siteKey(move, player);
+        territory.insert(move, player);
+        hash += moveKey;
+
+        double value = -search(depth - 1, -beta, -alpha, 1 - player, turnsLeft - 1, nullptr);
+
+        hash -= moveKey;
+        territory.undo();
+
+        if (timeUp) {
+            return 0.0;
+        }
+
+        if (value > bestValue) {
+            bestValue = value;
+            bestMove = move;
+        }
+        alpha = std::max(alpha, value);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    Bound bound = Bound::Exact;
+    if (bestValue <= alphaOrig) {
+        bound = Bound::Upper;
+    } else if (bestValue >= beta) {
+        bound = Bound::Lower;
+    }
+    table[key] = {depth, bestValue, bound, bestMove};
+
+    if (best) {
+        *best = bestMove;
+    }
+    return bestValue;
+}
+
+double MinimaxAI::evaluate(int player) {
+    return territory.area(player) - territory.area(1 - player);
+}
+
+void MinimaxAI::orderedMoves(int player, const sf::Vector2f* first, std::vector<sf::Vector2f>& moves) {
+    // Best immediate gains first, the generator prunes the hopeless candidates
+    candidates.best(territory, player, MAX_BRANCHING,
+                    [this, player](sf::Vector2f position) { return territory.gain(position, player); }, scored);
+
+    moves.clear();
+    if (first) {
+        moves.push_back(*first);
+    }
+    for (const Candidate& candidate : scored) {
+        if (!first || candidate.position != *first) {
+            moves.push_back(candidate.position);
+        }
+    }
+}
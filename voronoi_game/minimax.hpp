@@ -0,0 +1,62 @@
+#ifndef MINIMAX_HPP
+#define MINIMAX_HPP
+
+#include <SFML/System.hpp>
+#include "incremental_territory.hpp"
+#include "candidates.hpp"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct SearchResult {
+    sf::Vector2f move;
+    int depth;   // deepest fully searched iteration
+    double value; // territory difference for the player to move
+    long nodes;
+};
+
+// Alpha-beta over site placements, iterative deepening under a time budget.
+class MinimaxAI {
+public:
+    MinimaxAI(float width, float height, int timeBudgetMs = 100);
+    SearchResult chooseMove(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners,
+                            int player, int turnsLeft);
+
+private:
+    enum class Bound { Exact, Lower, Upper };
+
+    struct Entry {
+        int depth;
+        double value;
+        Bound bound;
+        sf::Vector2f best;
+    };
+
+    double search(int depth, double alpha, double beta, int player, int turnsLeft, sf::Vector2f* best);
+    double evaluate(int player);
+    void orderedMoves(int player, const sf::Vector2f* first, std::vector<sf::Vector2f>& moves);
+    uint64_t siteKey(sf::Vector2f position, int owner) const;
+
+    static const int GRID_COLUMNS = 16;
+    static const int GRID_ROWS = 10;
+    static const int MAX_BRANCHING = 8;
+    static const int MAX_DEPTH = 16;
+    static const size_t MAX_TABLE_SIZE = 1 << 20;
+    const float TT_QUANTUM = 4.0f; // positions closer than this hash to the same key
+
+    const float WIDTH;
+    const float HEIGHT;
+    std::chrono::milliseconds budget;
+    std::chrono::steady_clock::time_point deadline;
+    bool timeUp;
+    long nodes;
+
+    IncrementalTerritory territory; // make/unmake of the searched moves
+    CandidateGenerator candidates;
+    std::vector<Candidate> scored;
+    uint64_t hash; // order independent: sum of the keys of every site
+    std::unordered_map<uint64_t, Entry> table;
+};
+
+#endif // MINIMAX_HPP
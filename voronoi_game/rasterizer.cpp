@@ -0,0 +1,193 @@
+#include "rasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RASTERIZER_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Pixels [x, x1) of the row of centre py by groups of lanes, each given the
+// nearest of the m culled sites; returns the first pixel left to the scalar
+// loop. Sites are tested in index order with a strict comparison: ties go to
+// the lowest index, like the scalar loop and the shader
+#ifdef RASTERIZER_AVX2
+// Compiled for AVX2 without -mavx2: only called when the processor has it,
+// the rest of the program runs anywhere
+__attribute__((target("avx2"))) int rowAvx2(int x, int x1, float py, const float* cx, const float* cy,
+                                            const int* cid, size_t m, int* row) {
+    const __m256 lanes = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    for (; x + 8 <= x1; x += 8) {
+        const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lanes);
+        __m256 best = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        __m256 bestId = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t k = 0; k < m; ++k) {
+            const float dy = py - cy[k];
+            const __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(cx[k]));
+            const __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_set1_ps(dy * dy));
+            const __m256 closer = _mm256_cmp_ps(d, best, _CMP_LT_OQ);
+            best = _mm256_min_ps(d, best);
+            bestId = _mm256_blendv_ps(bestId, _mm256_castsi256_ps(_mm256_set1_epi32(cid[k])), closer);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + x), _mm256_castps_si256(bestId));
+    }
+    return x;
+}
+#endif
+
+#if defined(__SSE2__)
+int rowSse2(int x, int x1, float py, const float* cx, const float* cy, const int* cid, size_t m, int* row) {
+    const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    for (; x + 4 <= x1; x += 4) {
+        const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 bestId = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t k = 0; k < m; ++k) {
+            const float dy = py - cy[k];
+            const __m128 dx = _mm_sub_ps(px, _mm_set1_ps(cx[k]));
+            const __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_set1_ps(dy * dy));
+            const __m128 closer = _mm_cmplt_ps(d, best);
+            best = _mm_min_ps(d, best);
+            bestId = _mm_or_ps(_mm_and_ps(closer, _mm_castsi128_ps(_mm_set1_epi32(cid[k]))), _mm_andnot_ps(closer, bestId));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_castps_si128(bestId));
+    }
+    return x;
+}
+#endif
+
+bool supportsAvx2() {
+#ifdef RASTERIZER_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+}
+
+OwnershipRasterizer::OwnershipRasterizer(int width, int height, ThreadPool& pool, int tileSize)
+    : WIDTH(width), HEIGHT(height), TILE(tileSize),
+      columns((width + tileSize - 1) / tileSize), rows((height + tileSize - 1) / tileSize),
+      pool(pool), avx2(supportsAvx2()), players(0), siteIds(width * height, -1),
+      tileCounts(columns * rows) {}
+
+void OwnershipRasterizer::rasterize(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners, int playerCount) {
+    players = playerCount;
+    siteOwners = owners;
+    xs.resize(sites.size());
+    ys.resize(sites.size());
+    for (size_t i = 0; i < sites.size(); ++i) {
+        xs[i] = sites[i].x;
+        ys[i] = sites[i].y;
+    }
+
+    pool.parallelFor(tileCounts.size(), [this](size_t tile) {
+        thread_local TileSites culled;
+        rasterizeTile(tile, culled);
+    });
+
+    counts.assign(players, 0);
+    for (const auto& tile : tileCounts) {
+        for (int p = 0; p < players; ++p) {
+            counts[p] += tile[p];
+        }
+    }
+}
+
+void OwnershipRasterizer::rasterizeTile(size_t tile, TileSites& culled) {
+    const int x0 = static_cast<int>(tile % columns) * TILE;
+    const int y0 = static_cast<int>(tile / columns) * TILE;
+    const int x1 = std::min(x0 + TILE, WIDTH);
+    const int y1 = std::min(y0 + TILE, HEIGHT);
+
+    // Pixel centres of the tile span [left, right] x [top, bottom]
+    const float left = x0 + 0.5f;
+    const float right = x1 - 0.5f;
+    const float top = y0 + 0.5f;
+    const float bottom = y1 - 0.5f;
+
+    // A site whose nearest point of the tile is farther than some other
+    // site's farthest point can't win any pixel of the tile
+    const size_t n = xs.size();
+    float bound = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < n; ++i) {
+        float fx = std::max(std::abs(xs[i] - left), std::abs(xs[i] - right));
+        float fy = std::max(std::abs(ys[i] - top), std::abs(ys[i] - bottom));
+        bound = std::min(bound, fx * fx + fy * fy);
+    }
+
+    culled.xs.clear();
+    culled.ys.clear();
+    culled.ids.clear();
+    for (size_t i = 0; i < n; ++i) {
+        float nx = std::max({left - xs[i], 0.0f, xs[i] - right});
+        float ny = std::max({top - ys[i], 0.0f, ys[i] - bottom});
+        if (nx * nx + ny * ny <= bound) {
+            culled.xs.push_back(xs[i]);
+            culled.ys.push_back(ys[i]);
+            culled.ids.push_back(static_cast<int>(i));
+        }
+    }
+
+    const size_t m = culled.ids.size();
+    const float* cx = culled.xs.data();
+    const float* cy = culled.ys.data();
+    const int* cid = culled.ids.data();
+
+    std::vector<long>& count = tileCounts[tile];
+    count.assign(players, 0);
+
+    for (int y = y0; y < y1; ++y) {
+        const float py = y + 0.5f;
+        int* row = &siteIds[static_cast<size_t>(y) * WIDTH];
+        int x = x0;
+
+#ifdef RASTERIZER_AVX2
+        if (avx2) {
+            x = rowAvx2(x, x1, py, cx, cy, cid, m, row);
+        }
+#endif
+#if defined(__SSE2__)
+        x = rowSse2(x, x1, py, cx, cy, cid, m, row);
+#endif
+        for (; x < x1; ++x) {
+            const float px = x + 0.5f;
+            float best = std::numeric_limits<float>::infinity();
+            int bestId = -1;
+            for (size_t k = 0; k < m; ++k) {
+                const float dx = px - cx[k];
+                const float dy = py - cy[k];
+                const float d = dx * dx + dy * dy;
+                if (d < best) {
+                    best = d;
+                    bestId = cid[k];
+                }
+            }
+            row[x] = bestId;
+        }
+
+        for (x = x0; x < x1; ++x) {
+            if (row[x] >= 0) {
+                count[siteOwners[row[x]]]++;
+            }
+        }
+    }
+}
+
+void OwnershipRasterizer::toImage(sf::Image& image, const std::vector<sf::Color>& palette) const {
+    std::vector<sf::Uint8> pixels(siteIds.size() * 4);
+    for (size_t i = 0; i < siteIds.size(); ++i) {
+        sf::Color color = (siteIds[i] >= 0) ? palette[siteOwners[siteIds[i]]] : sf::Color::White;
+        pixels[4 * i + 0] = color.r;
+        pixels[4 * i + 1] = color.g;
+        pixels[4 * i + 2] = color.b;
+        pixels[4 * i + 3] = color.a;
+    }
+    image.create(WIDTH, HEIGHT, pixels.data());
+}
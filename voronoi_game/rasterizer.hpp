@@ -0,0 +1,53 @@
+#ifndef RASTERIZER_HPP
+#define RASTERIZER_HPP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "thread_pool.hpp"
+
+// CPU replacement for voronoiColors.frag: nearest site of every pixel centre.
+// The board is cut into tiles spread over the pool; each tile first drops the
+// sites that cannot win anywhere inside it, then tests the remaining ones
+// against 8 (AVX2, when the processor has it) or 4 (SSE2) pixels at a time.
+class OwnershipRasterizer {
+public:
+    OwnershipRasterizer(int width, int height, ThreadPool& pool, int tileSize = 64);
+
+    void rasterize(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners, int players);
+
+    // Nearest site index of every pixel, row-major, -1 when there is no site
+    const std::vector<int>& siteBuffer() const { return siteIds; }
+    const std::vector<long>& playerCounts() const { return counts; }
+
+    // Debug view: every pixel painted with the colour of its owner
+    void toImage(sf::Image& image, const std::vector<sf::Color>& palette) const;
+
+private:
+    struct TileSites {
+        std::vector<float> xs;
+        std::vector<float> ys;
+        std::vector<int> ids;
+    };
+
+    void rasterizeTile(size_t tile, TileSites& culled);
+
+    const int WIDTH;
+    const int HEIGHT;
+    const int TILE;
+    const int columns;
+    const int rows;
+    ThreadPool& pool;
+    const bool avx2; // checked once at run time, the build doesn't assume it
+
+    // SoA copy of the sites of the current call
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<int> siteOwners;
+    int players;
+
+    std::vector<int> siteIds;
+    std::vector<long> counts;
+    std::vector<std::vector<long>> tileCounts;
+};
+
+#endif // RASTERIZER_HPP
@@ -0,0 +1,213 @@
+// Headless batch runner: plays matches between two agents without opening a window.
+// Usage: ./simulate [matches] [agent1] [agent2], agents being random, greedy, minimax or mcts.
+//        ./simulate mcts-scaling [budgetMs] reports MCTS playouts/sec from 1 to N threads.
+//        ./simulate candidates [positions] compares the candidate generator with a plain grid.
+//        ./simulate flood [maxSites] times jump flooding against the exact rasterizer.
+#include "engine.hpp"
+#include "agents.hpp"
+#include "mcts.hpp"
+#include "candidates.hpp"
+#include "thread_pool.hpp"
+#include "rasterizer.hpp"
+#include "jump_flooding.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1200;
+const int HEIGHT = 800;
+const int MAX_TURNS = 10;
+
+GameEngine::Agent makeAgent(const std::string& name, unsigned seed) {
+    if (name == "greedy") {
+        return greedyAgent();
+    }
+    if (name == "minimax") {
+        return minimaxAgent(100);
+    }
+    if (name == "mcts") {
+        return mctsAgent(100, 1); // matches already run in parallel
+    }
+    return randomAgent(seed);
+}
+
+// Searches the same mid-game position with 1, 2, 4 ... N workers
+int mctsScaling(int budgetMs) {
+    GameEngine position(WIDTH, HEIGHT, MAX_TURNS);
+    GameEngine::Agent opening[2] = {greedyAgent(), randomAgent(1)};
+    for (int i = 0; i < 4; ++i) {
+        position.step(opening[position.currentPlayer()]);
+    }
+
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+
+    double single = 0.0;
+    for (unsigned threads : counts) {
+        MctsConfig config;
+        config.threads = threads;
+        config.timeBudgetMs = budgetMs;
+        MctsAI ai(config);
+
+        const int runs = 3;
+        long playouts = 0;
+        double seconds = 0.0;
+        for (int r = 0; r < runs; ++r) {
+            MctsResult result = ai.chooseMove(position);
+            playouts += result.playouts;
+            seconds += result.seconds;
+        }
+
+        double rate = playouts / seconds;
+        if (threads == 1) {
+            single = rate;
+        }
+        std::cout << threads << " threads: " << static_cast<long>(rate) << " playouts/s, efficiency "
+                  << 100.0 * rate / (threads * single) << " %" << std::endl;
+    }
+
+    return 0;
+}
+
+// Best move of the generator against the best of a 16 x 10 grid, on random positions
+int candidateReport(int positions) {
+    const int columns = 16;
+    const int rows = 10;
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> x(0.0f, WIDTH);
+    std::uniform_real_distribution<float> y(0.0f, HEIGHT);
+    CandidateGenerator generator(columns, rows);
+    std::vector<Candidate> best;
+    int worse = 0;
+    int better = 0;
+
+    for (int p = 0; p < positions; ++p) {
+        GameEngine engine(WIDTH, HEIGHT, 2 * MAX_TURNS);
+        int moves = p % (2 * MAX_TURNS);
+        for (int m = 0; m < moves; ++m) {
+            engine.applyMove(sf::Vector2f(x(gen), y(gen)));
+        }
+
+        double gridBest = -std::numeric_limits<double>::infinity();
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < columns; ++c) {
+                gridBest = std::max(gridBest, engine.gain(sf::Vector2f((c + 0.5f) * WIDTH / columns, (r + 0.5f) * HEIGHT / rows)));
+            }
+        }
+
+        generator.best(engine.cells(), engine.currentPlayer(), 1,
+                       [&engine](sf::Vector2f position) { return engine.gain(position); }, best);
+        worse += best[0].gain < gridBest - 1e-6;
+        better += best[0].gain > gridBest + 1e-6;
+    }
+
+    std::cout << "grid: " << columns * rows << " evaluations per position" << std::endl;
+    std::cout << "generator: " << double(generator.proposals()) / positions << " proposals, "
+              << double(generator.evaluations()) / positions << " evaluations per position" << std::endl;
+    std::cout << "generator move better on " << better << ", worse on " << worse << " of " << positions << " positions" << std::endl;
+    return 0;
+}
+
+// Cost and error of the flood on random sites, from 16 up to `maxSites`. A
+// pixel is wrong when its site is farther than the exact nearest one.
+int floodReport(int maxSites) {
+    ThreadPool pool;
+    OwnershipRasterizer rasterizer(WIDTH, HEIGHT, pool);
+    JumpFlooding flood(WIDTH, HEIGHT, pool);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> x(0.0f, WIDTH);
+    std::uniform_real_distribution<float> y(0.0f, HEIGHT);
+
+    for (int n = 16; n <= maxSites; n *= 4) {
+        std::vector<sf::Vector2f> sites(n);
+        std::vector<int> owners(n);
+        for (int i = 0; i < n; ++i) {
+            sites[i] = sf::Vector2f(x(gen), y(gen));
+            owners[i] = i % 2;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        rasterizer.rasterize(sites, owners, 2);
+        auto middle = std::chrono::steady_clock::now();
+        flood.flood(sites, owners, 2);
+        auto end = std::chrono::steady_clock::now();
+
+        long wrong = 0;
+        for (int py = 0; py < HEIGHT; ++py) {
+            for (int px = 0; px < WIDTH; ++px) {
+                const size_t i = static_cast<size_t>(py) * WIDTH + px;
+                const sf::Vector2f& exact = sites[rasterizer.siteBuffer()[i]];
+                float best = std::hypot(px + 0.5f - exact.x, py + 0.5f - exact.y);
+                wrong += flood.distanceField()[i] > best + 1e-3f;
+            }
+        }
+        long areaError = std::abs(rasterizer.playerCounts()[0] - flood.playerCounts()[0]);
+
+        std::cout << n << " sites: raster " << std::chrono::duration<double, std::milli>(middle - start).count()
+                  << " ms, flood " << std::chrono::duration<double, std::milli>(end - middle).count() << " ms, "
+                  << 100.0 * wrong / (WIDTH * HEIGHT) << " % pixels wrong, area error "
+                  << 100.0 * areaError / (WIDTH * HEIGHT) << " %" << std::endl;
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char const* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "mcts-scaling") {
+        return mctsScaling((argc > 2) ? std::atoi(argv[2]) : 1000);
+    }
+    if (argc > 1 && std::string(argv[1]) == "flood") {
+        return floodReport((argc > 2) ? std::atoi(argv[2]) : 65536);
+    }
+    if (argc > 1 && std::string(argv[1]) == "candidates") {
+        return candidateReport((argc > 2) ? std::atoi(argv[2]) : 1000);
+    }
+
+    const int matches = (argc > 1) ? std::atoi(argv[1]) : 10000;
+    const std::string first = (argc > 2) ? argv[2] : "greedy";
+    const std::string second = (argc > 3) ? argv[3] : "random";
+
+    ThreadPool pool;
+    std::atomic<int> wins[2];
+    std::atomic<int> ties(0);
+    wins[0] = 0;
+    wins[1] = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(matches, [&](size_t match) {
+        GameEngine engine(WIDTH, HEIGHT, MAX_TURNS);
+        GameEngine::Agent agents[2] = {makeAgent(first, 2 * match), makeAgent(second, 2 * match + 1)};
+
+        while (engine.step(agents[engine.currentPlayer()])) {
+        }
+
+        int winner = engine.winner();
+        if (winner < 0) {
+            ties++;
+        } else {
+            wins[winner]++;
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << first << " vs " << second << ": " << wins[0] << " / " << wins[1] << " (" << ties << " ties)" << std::endl;
+    std::cout << matches << " matches in " << seconds << " s on " << pool.size() << " threads, "
+              << matches / seconds * 60.0 << " matches/min" << std::endl;
+
+    return 0;
+}
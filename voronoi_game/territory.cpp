@@ -0,0 +1,186 @@
+#include "territory.hpp"
+#include <boost/polygon/voronoi.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+using boost::polygon::voronoi_diagram;
+using boost::polygon::point_data;
+
+std::vector<std::vector<int>> voronoiNeighbours(const std::vector<sf::Vector2f>& sites) {
+    std::vector<std::vector<int>> neighbours(sites.size());
+    if (sites.size() < 2) {
+        return neighbours;
+    }
+
+    // Group the sites that fall on the same quantized point: boost sees them as one
+    std::vector<std::pair<long, long>> keys(sites.size());
+    for (size_t i = 0; i < sites.size(); ++i) {
+        keys[i] = {std::lround(sites[i].x * TERRITORY_QUANTUM), std::lround(sites[i].y * TERRITORY_QUANTUM)};
+    }
+
+    std::vector<int> order(sites.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+
+    std::vector<point_data<int>> inputPoints;
+    std::vector<std::vector<int>> groups;
+    for (size_t k = 0; k < order.size(); ++k) {
+        int i = order[k];
+        if (k == 0 || keys[i] != keys[order[k - 1]]) {
+            inputPoints.emplace_back(static_cast<int>(keys[i].first), static_cast<int>(keys[i].second));
+            groups.emplace_back();
+        }
+        groups.back().push_back(i);
+    }
+
+    for (const auto& group : groups) {
+        for (int i : group) {
+            for (int j : group) {
+                if (i != j) {
+                    neighbours[i].push_back(j);
+                }
+            }
+        }
+    }
+
+    if (inputPoints.size() < 2) {
+        return neighbours;
+    }
+
+    voronoi_diagram<double> vd;
+    construct_voronoi(inputPoints.begin(), inputPoints.end(), &vd);
+
+    for (auto it = vd.cells().begin(); it != vd.cells().end(); ++it) {
+        const voronoi_diagram<double>::cell_type& cell = *it;
+        const voronoi_diagram<double>::edge_type* edge = cell.incident_edge();
+        if (!edge) {
+            continue;
+        }
+
+        const std::vector<int>& group = groups[cell.source_index()];
+        do {
+            const std::vector<int>& other = groups[edge->twin()->cell()->source_index()];
+            for (int i : group) {
+                neighbours[i].insert(neighbours[i].end(), other.begin(), other.end());
+            }
+            edge = edge->next();
+        } while (edge != cell.incident_edge());
+    }
+
+    return neighbours;
+}
+
+std::vector<sf::Vector2<double>> clippedCell(const std::vector<sf::Vector2f>& sites, int site,
+                                             const std::vector<int>& neighbours, float width, float height) {
+    std::vector<sf::Vector2<double>> polygon = {{0.0, 0.0}, {double(width), 0.0}, {double(width), double(height)}, {0.0, double(height)}};
+    std::vector<sf::Vector2<double>> clipped;
+    const double sx = sites[site].x;
+    const double sy = sites[site].y;
+
+    for (int n : neighbours) {
+        const double nx = sites[n].x;
+        const double ny = sites[n].y;
+
+        // Coincident sites: the lowest index owns the cell, like the pixel counter
+        if (nx == sx && ny == sy) {
+            if (n < site) {
+                return {};
+            }
+            continue;
+        }
+
+        // Keep the points p with a.p <= b, i.e. closer to the site than to the neighbour
+        const double ax = nx - sx;
+        const double ay = ny - sy;
+        const double b = 0.5 * (nx * nx + ny * ny - sx * sx - sy * sy);
+
+        clipped.clear();
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            const sf::Vector2<double>& p = polygon[i];
+            const sf::Vector2<double>& q = polygon[(i + 1) % polygon.size()];
+            double dp = ax * p.x + ay * p.y - b;
+            double dq = ax * q.x + ay * q.y - b;
+
+            if (dp <= 0) {
+                clipped.push_back(p);
+            }
+            if ((dp < 0 && dq > 0) || (dp > 0 && dq < 0)) {
+                double t = dp / (dp - dq);
+                clipped.emplace_back(p.x + t * (q.x - p.x), p.y + t * (q.y - p.y));
+            }
+        }
+
+        polygon.swap(clipped);
+        if (polygon.size() < 3) {
+            return {};
+        }
+    }
+
+    return polygon;
+}
+
+double polygonArea(const std::vector<sf::Vector2<double>>& polygon) {
+    double area = 0.0;
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        const sf::Vector2<double>& p = polygon[i];
+        const sf::Vector2<double>& q = polygon[(i + 1) % polygon.size()];
+        area += p.x * q.y - q.x * p.y;
+    }
+    return std::abs(area) / 2.0;
+}
+
+std::vector<double> cellAreas(const std::vector<sf::Vector2f>& sites, float width, float height) {
+    std::vector<std::vector<int>> neighbours = voronoiNeighbours(sites);
+    std::vector<double> areas(sites.size(), 0.0);
+
+    for (size_t i = 0; i < sites.size(); ++i) {
+        areas[i] = polygonArea(clippedCell(sites, static_cast<int>(i), neighbours[i], width, height));
+    }
+
+    return areas;
+}
+
+std::vector<double> territoryAreas(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners,
+                                   int players, float width, float height) {
+    std::vector<double> areas(players, 0.0);
+    std::vector<double> cells = cellAreas(sites, width, height);
+
+    for (size_t i = 0; i < cells.size(); ++i) {
+        areas[owners[i]] += cells[i];
+    }
+
+    return areas;
+}
+
+std::vector<double> pixelTerritoryAreas(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners,
+                                        int players, int width, int height) {
+    std::vector<double> areas(players, 0.0);
+
+    // Parcourez chaque pixel de la fenêtre
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            sf::Vector2f point(x, height - y);
+            float minDist = std::numeric_limits<float>::max();
+            int closestSite = -1;
+
+            // Trouvez le site de Voronoi le plus proche
+            for (size_t i = 0; i < sites.size(); ++i) {
+                float dist = std::pow(sites[i].x - point.x, 2) + std::pow(sites[i].y - point.y, 2);
+                if (dist < minDist) {
+                    minDist = dist;
+                    closestSite = static_cast<int>(i);
+                }
+            }
+
+            // Augmentez l'aire du joueur correspondant
+            if (closestSite != -1) {
+                areas[owners[closestSite]]++;
+            }
+        }
+    }
+
+    return areas;
+}
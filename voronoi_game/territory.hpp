@@ -0,0 +1,46 @@
+#ifndef TERRITORY_HPP
+#define TERRITORY_HPP
+
+#include <SFML/System.hpp>
+#include <vector>
+
+enum class ScoringMode {
+    Exact,  // Voronoi cells clipped to the board, resolution independent
+    Raster, // multithreaded SIMD pixel counter (OwnershipRasterizer)
+    Flood,  // jump flooding, approximate but independent of the number of sites
+    Pixel   // per-pixel nearest site counter, kept as a reference
+};
+
+// From this many sites on, a Raster score is computed by jump flooding: the
+// rasterizer's cost grows with the sites, the flood's does not. An Exact score
+// never switches: it is read from the areas IncrementalTerritory keeps after
+// every move, O(players) at any site count, where a flood would be slower and
+// approximate. Flood stays available on request, and for drawing boards with
+// more sites than the shader takes.
+const size_t FLOOD_THRESHOLD = 8192;
+
+// Sites are snapped to a 1/QUANTUM pixel grid before being handed to boost,
+// which only accepts integer input.
+const int TERRITORY_QUANTUM = 256;
+
+// Voronoi neighbours of every site. Coincident sites are neighbours of each other.
+std::vector<std::vector<int>> voronoiNeighbours(const std::vector<sf::Vector2f>& sites);
+
+// Cell of `site` clipped to [0, width] x [0, height] and to the bisectors with `neighbours`.
+std::vector<sf::Vector2<double>> clippedCell(const std::vector<sf::Vector2f>& sites, int site,
+                                             const std::vector<int>& neighbours, float width, float height);
+
+double polygonArea(const std::vector<sf::Vector2<double>>& polygon);
+
+// Exact area of every cell, O(n log n) in the number of sites.
+std::vector<double> cellAreas(const std::vector<sf::Vector2f>& sites, float width, float height);
+
+// Exact area owned by each player, `owners[i]` being the player of `sites[i]`.
+std::vector<double> territoryAreas(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners,
+                                   int players, float width, float height);
+
+// Reference counter: nearest site of every pixel, O(width * height * n).
+std::vector<double> pixelTerritoryAreas(const std::vector<sf::Vector2f>& sites, const std::vector<int>& owners,
+                                        int players, int width, int height);
+
+#endif // TERRITORY_HPP
@@ -1,13 +1,16 @@
 #include "voronoi.hpp"
+#include "jump_flooding.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 
-Voronoi::Voronoi(int width, int height, int maxTurns)
-    : WIDTH(width), HEIGHT(height), maxTurns(maxTurns), currentPlayer(0), turnCount(0), gameEnded(false),
-      window(sf::VideoMode(WIDTH, HEIGHT), "Voronoi Game", sf::Style::Close | sf::Style::Titlebar, sf::ContextSettings(0, 0, 8)) {
+Voronoi::Voronoi(int width, int height, int maxTurns, int aiPlayer)
+    : WIDTH(width), HEIGHT(height), aiPlayer(aiPlayer), gameEnded(false),
+      scoringMode(ScoringMode::Exact),
+      engine(width, height, maxTurns), ai(width, height),
+      window(sf::VideoMode(WIDTH, HEIGHT), "Voronoi Game", sf::Style::Close | sf::Style::Titlebar, sf::ContextSettings(0, 0, 8)),
+      diagramDirty(true) {
     window.setFramerateLimit(60);
-    playerScores.resize(2, 0);
     window.setPosition(sf::Vector2i(0, 0));
     // colors.reserve(maxTurns); // Réservez suffisamment d'espace pour le vecteur colors
 }
@@ -31,10 +34,19 @@ bool Voronoi::initialize() {
 #else 
     "voronoi.frag";
 #endif
+    if (!diagram.create(WIDTH, HEIGHT)) {
+        std::cerr << "Failed to create the diagram texture!" << std::endl;
+        return false;
+    }
+
     std::cout << "Initialisation du jeu..." << std::endl;
     return true; // Retourne true si l'initialisation réussit
 }
 
+void Voronoi::setScoringMode(ScoringMode mode) {
+    scoringMode = mode;
+}
+
 void Voronoi::run() {
     if (!initialize()) {
         return;
@@ -56,7 +68,8 @@ void Voronoi::handleEvents() {
             window.close();
         }
 
-        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left && turnCount < maxTurns) {
+        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left && !engine.finished()
+            && engine.currentPlayer() != aiPlayer) {
             sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
             addPoint(mousePos);
         }
@@ -65,58 +78,23 @@ void Voronoi::handleEvents() {
 
 void Voronoi::update() {
     // Update game state if necessary
-    if (turnCount == maxTurns) {
+    if (engine.currentPlayer() == aiPlayer && !engine.finished()) {
+        playAI();
+    }
+
+    if (engine.finished()) {
         calculateWinner();
         gameEnded = true;
     }
 }
 
-void Voronoi::calculateAreas(std::vector<int>& areas) {
-    areas.clear();
-    areas.resize(2, 0); // On a deux joueurs, donc deux aires à calculer
-
-    // Parcourez chaque pixel de la fenêtre
-    for (int y = 0; y < HEIGHT; ++y) {
-        for (int x = 0; x < WIDTH; ++x) {
-            sf::Vector2f point(x, HEIGHT - y);
-            float minDist = std::numeric_limits<float>::max();
-            int closestSite = -1;
-
-            // Trouvez le site de Voronoi le plus proche
-            for (int i = 0; i < coordinates.size(); ++i) {
-                float dist = std::pow(coordinates[i].x - point.x, 2) + std::pow(coordinates[i].y - point.y, 2);
-                if (dist < minDist) {
-                    minDist = dist;
-                    closestSite = i;
-                }
-            }
-
-            // Augmentez l'aire du joueur correspondant
-            if (closestSite != -1) {
-                if (colors[closestSite] == sf::Vector3f(1.0f, 0.0f, 0.0f)) { // Rouge
-                    areas[0]++;
-                } else if (colors[closestSite] == sf::Vector3f(0.0f, 0.0f, 1.0f)) { // Bleu
-                    areas[1]++;
-                }
-            }
-        }
+void Voronoi::render() {
+    if (diagramDirty) {
+        renderDiagram();
     }
-}
 
-
-void Voronoi::render() {
     window.clear(sf::Color::White);
-
-    std::vector<sf::Vector2f> copy(coordinates.size());
-    std::transform(coordinates.begin(), coordinates.end(), copy.begin(), [&](sf::Vector2f vec) {
-        return sf::Vector2f(vec.x, window.getSize().y - vec.y);
-    });
-
-    shader.setUniform("size", static_cast<int>(coordinates.size()));
-    shader.setUniformArray("seeds", copy.data(), static_cast<int>(coordinates.size()));
-    shader.setUniformArray("colors", colors.data(), static_cast<int>(colors.size()));
-
-    window.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
+    window.draw(sf::Sprite(diagram.getTexture()));
 
     for (auto& c : circles) {
         window.draw(c.first);
@@ -125,8 +103,37 @@ void Voronoi::render() {
     window.display();
 }
 
+void Voronoi::renderDiagram() {
+    diagram.clear(sf::Color::White);
+
+    const std::vector<sf::Vector2f>& coordinates = engine.sites();
+    if (coordinates.size() > static_cast<size_t>(MAX_POINTS_NUMBER)) {
+        engine.floodMap().toImage(floodImage, {sf::Color::Red, sf::Color::Blue});
+        floodTexture.loadFromImage(floodImage);
+        diagram.draw(sf::Sprite(floodTexture));
+    } else {
+        std::vector<sf::Vector2f> copy(coordinates.size());
+        std::transform(coordinates.begin(), coordinates.end(), copy.begin(), [&](sf::Vector2f vec) {
+            return sf::Vector2f(vec.x, diagram.getSize().y - vec.y);
+        });
+
+        shader.setUniform("size", static_cast<int>(coordinates.size()));
+        shader.setUniformArray("seeds", copy.data(), static_cast<int>(coordinates.size()));
+        shader.setUniformArray("colors", colors.data(), static_cast<int>(colors.size()));
+
+        diagram.draw(sf::RectangleShape(sf::Vector2f(WIDTH, HEIGHT)), &shader);
+    }
+
+    diagram.display();
+    diagramDirty = false;
+}
+
 void Voronoi::addPoint(sf::Vector2f position) {
-    coordinates.push_back(position);
+    const int player = engine.currentPlayer();
+    if (!engine.applyMove(position)) {
+        return;
+    }
+
     sf::CircleShape tempPoint(4, 100);
     tempPoint.setFillColor(sf::Color::Black);
     tempPoint.setOrigin(4, 4);
@@ -135,24 +142,29 @@ void Voronoi::addPoint(sf::Vector2f position) {
     circles.push_back({tempPoint, false});
 
     // Add color for the current player
-    if (currentPlayer == 0) {
+    if (player == 0) {
         colors.push_back(sf::Vector3f(1.0f, 0.0f, 0.0f)); // Rouge
     } else {
         colors.push_back(sf::Vector3f(0.0f, 0.0f, 1.0f)); // Bleu
     }
-
-    playerScores[currentPlayer]++;
-    turnCount++;
-    switchPlayer();
+    diagramDirty = true;
 }
 
-void Voronoi::switchPlayer() {
-    currentPlayer = (currentPlayer + 1) % 2;
+void Voronoi::playAI() {
+    SearchResult result = ai.chooseMove(engine.sites(), engine.owners(), engine.currentPlayer(), engine.turnsLeft());
+    std::cout << "AI plays (" << result.move.x << ", " << result.move.y << "), depth " << result.depth
+              << ", " << result.nodes << " nodes" << std::endl;
+    addPoint(result.move);
 }
 
 void Voronoi::calculateWinner() {
-    std::vector<int> areas;
-    calculateAreas(areas);
+    std::vector<double> areas = engine.score(scoringMode);
+
+#ifdef SCORING_CROSSCHECK
+    std::vector<double> reference = engine.score(ScoringMode::Pixel);
+    std::cout << "Exact vs pixel: " << areas[0] << " / " << reference[0] << ", "
+              << areas[1] << " / " << reference[1] << std::endl;
+#endif
 
     int winner = (areas[0] > areas[1]) ? 0 : 1;
     std::cout << "Player " << winner + 1 << " wins!" << std::endl;
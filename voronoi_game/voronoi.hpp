@@ -4,35 +4,48 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <random>
+#include "engine.hpp"
+#include "minimax.hpp"
 
 class Voronoi {
 public:
-    Voronoi(int width, int height, int maxTurns);
+    Voronoi(int width, int height, int maxTurns, int aiPlayer = -1);
     bool initialize();
     void run();
+    void setScoringMode(ScoringMode mode);
 
 private:
     void handleEvents();
     void update();
     void render();
+    void renderDiagram();
     void addPoint(sf::Vector2f position);
-    void switchPlayer();
+    void playAI();
     void calculateWinner();
-    void calculateAreas(std::vector<int>& areas); 
 
     const int WIDTH;
     const int HEIGHT;
-    int maxTurns;
-    int currentPlayer;
-    int turnCount;
+    int aiPlayer; // -1: two human players
     bool gameEnded;
+    ScoringMode scoringMode;
     const int MAX_POINTS_NUMBER = 512;
 
+    GameEngine engine;
+    MinimaxAI ai;
+
     sf::RenderWindow window;
     sf::Shader shader;
-    std::vector<sf::Vector2f> coordinates;
+
+    // The board only changes when a site is added: it is drawn once into
+    // `diagram`, by the shader or, past MAX_POINTS_NUMBER sites which the
+    // shader can't hold, from the engine's jump flooding map. The sites are
+    // drawn on top of it every frame.
+    sf::RenderTexture diagram;
+    bool diagramDirty;
+    sf::Image floodImage;
+    sf::Texture floodTexture;
     std::vector<std::pair<sf::CircleShape, bool>> circles;
-    
+
 #ifdef COLORS
     std::vector<sf::Vector3f> colors;
 #endif
@@ -40,7 +53,6 @@ private:
     std::default_random_engine gen;
     // std::uniform_real_distribution<float> frand;
 
-    std::vector<int> playerScores;
 #ifdef COLORS
     std::uniform_real_distribution<> frand;
 #endif